@@ -0,0 +1,68 @@
+/*
+    This file is part of LibQtLua.
+
+    LibQtLua is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibQtLua is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LibQtLua.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright (C) 2008, Alexandre Becoulet <alexandre.becoulet@free.fr>
+
+*/
+
+#include <iostream>
+
+#include <QCoreApplication>
+#include <QTimer>
+
+#include <QtLua/State>
+#include <QtLua/Function>
+#include <QtLua/Pending>
+
+/* anchor 1 */
+QTLUA_FUNCTION(sleep)
+{
+	int ms = get_arg<int>(args, 0);
+
+	// suspend calling coroutine, resumed from event loop later
+	QtLua::Pending *pending = suspend(ls);
+
+	QTimer::singleShot(ms, pending, SLOT(resume()));
+
+	return QtLua::Value::List();
+}
+
+int main(int argc, char *argv[])
+{
+	QCoreApplication app(argc, argv);
+
+	try
+	{
+		QtLua::State state;
+
+		QTLUA_FUNCTION_REGISTER(&state, "", sleep);
+
+		state.openlib(QtLua::AllLibs);
+		state.enable_qdebug_print(true);
+
+		state.exec_statements("co = coroutine.create(function() print(\"wait\") sleep(100) print(\"done\") end)");
+		state.exec_statements("coroutine.resume(co)");
+
+		QTimer::singleShot(200, &app, SLOT(quit()));
+		app.exec();
+	}
+	catch (QtLua::String &e)
+	{
+		std::cerr << e.constData() << std::endl;
+	}
+
+	return 0;
+}
@@ -0,0 +1,55 @@
+/*
+    This file is part of LibQtLua.
+
+    LibQtLua is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibQtLua is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LibQtLua.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright (C) 2008, Alexandre Becoulet <alexandre.becoulet@free.fr>
+
+*/
+
+#include <iostream>
+
+#include <QCoreApplication>
+#include <QTimer>
+
+#include <QtLua/State>
+#include <QtLua/Scheduler>
+
+int main(int argc, char *argv[])
+{
+	QCoreApplication app(argc, argv);
+
+	try
+	{
+		/* anchor 1 */
+		QtLua::State state;
+		state.openlib(QtLua::AllLibs);
+		state.enable_qdebug_print(true);
+
+		// lua tasks run from the Qt event loop
+		QtLua::Scheduler scheduler(&state);
+
+		state.exec_statements("sched.spawn(function() for i = 1, 3 do print('tick', i) sched.sleep(100) end end)");
+		state.exec_statements("sched.spawn(function() for i = 1, 3 do print('yield', i) sched.yield() end end)");
+
+		QTimer::singleShot(500, &app, SLOT(quit()));
+		app.exec();
+	}
+	catch (QtLua::String &e)
+	{
+		std::cerr << e.constData() << std::endl;
+	}
+
+	return 0;
+}
@@ -0,0 +1,144 @@
+/*
+    This file is part of LibQtLua.
+
+    LibQtLua is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibQtLua is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LibQtLua.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright (C) 2008, Alexandre Becoulet <alexandre.becoulet@free.fr>
+
+*/
+
+#ifndef QTLUABUFFERPROXY_HH_
+#define QTLUABUFFERPROXY_HH_
+
+#include <QByteArray>
+#include <QFile>
+
+#include "qtluauserdata.hh"
+#include "qtluafunction.hh"
+#include "qtluastring.hh"
+
+namespace QtLua {
+
+/**
+   * @short Read only byte buffer access wrapper for lua script
+   * @header QtLua/BufferProxy
+   * @module {Container proxies}
+   *
+   * This class exposes a block of binary data to lua script without
+   * copying it to the lua heap. The data is either a memory mapped
+   * file or a shared @ref QByteArray object.
+   *
+   * The @tt{buffer[i]} expression returns the byte value at offset
+   * @tt i. First byte has index 1 and lua @tt nil value is returned
+   * when reading out of bounds. Lua operator @tt # returns the buffer
+   * size.
+   *
+   * The following methods are available from lua:
+   *
+   * @list
+   *   @item @tt{buffer:sub(i, j)} returns a lua string copy of bytes
+   *     from offset @tt i to offset @tt j with the same semantic as the
+   *     lua @tt string.sub function.
+   *   @item @tt{buffer:find(str, init)} returns the first and last
+   *     offsets of the first occurrence of @tt str found at or after
+   *     offset @tt init, or @tt nil.
+   *   @item @tt{buffer:u8(i)}, @tt{buffer:i8(i)}, @tt{buffer:u16le(i)},
+   *     @tt{buffer:i16le(i)}, @tt{buffer:u32le(i)}, @tt{buffer:i32le(i)},
+   *     @tt{buffer:f32(i)} and @tt{buffer:f64(i)} read a little endian
+   *     value at offset @tt i. Big endian variants are named with
+   *     a @tt be suffix instead, @tt{buffer:u16be(i)} or
+   *     @tt{buffer:f32be(i)} for instance.
+   * @end list
+   *
+   * Buffers can be created from lua using the @tt{qt.buffer.from_file}
+   * and @tt{qt.buffer.from_data} functions of the @ref QtLib library.
+   */
+
+class BufferProxy : public UserData
+{
+public:
+	QTLUA_REFTYPE(BufferProxy)
+
+	/** Create an empty @ref BufferProxy object */
+	BufferProxy();
+	/** Create a @ref BufferProxy object which shares given data */
+	BufferProxy(const QByteArray &data);
+	~BufferProxy();
+
+	/** Share given data, any mapped file is released */
+	void set_data(const QByteArray &data);
+	/** Map given file read only, @This returns false on error */
+	bool map_file(const QString &filename);
+
+	/** Get buffer size */
+	inline int size() const;
+	/** Get pointer to buffer data */
+	inline const uchar *data() const;
+
+	Value meta_operation(State *ls, Value::Operation op, const Value &a, const Value &b);
+	Value meta_index(State *ls, const Value &key);
+	bool meta_contains(State *ls, const Value &key);
+	bool support(Value::Operation c) const;
+
+private:
+	void release();
+	const uchar *get_ptr(int offset, int size) const;
+
+	/** Lua callable methods */
+	enum MethodId
+	{
+		MethodSub,
+		MethodFind,
+		MethodU8,
+		MethodI8,
+		MethodU16le,
+		MethodU16be,
+		MethodI16le,
+		MethodI16be,
+		MethodU32le,
+		MethodU32be,
+		MethodI32le,
+		MethodI32be,
+		MethodF32le,
+		MethodF32be,
+		MethodF64le,
+		MethodF64be
+	};
+
+	/**
+   * @short BufferProxy lua method class
+   * @internal
+   */
+	class BufferMethod : public Function
+	{
+	public:
+		BufferMethod(MethodId id);
+
+	private:
+		Value::List meta_call(State *ls, const Value::List &args);
+
+		MethodId _id;
+	};
+
+	static Value get_method(State *ls, const String &name);
+
+	QByteArray _data;
+	QFile _file;
+	const uchar *_ptr; //< mapped file or shared data
+	int _size;
+};
+
+}
+
+#endif
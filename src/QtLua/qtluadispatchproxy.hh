@@ -21,8 +21,11 @@
 #ifndef QTLUADISPATCHPROXY_HH_
 #define QTLUADISPATCHPROXY_HH_
 
+#include <QHash>
+
 #include "qtluauserdata.hh"
 #include "qtluaiterator.hh"
+#include "qtluastring.hh"
 
 namespace QtLua {
 
@@ -47,6 +50,12 @@ namespace QtLua {
    * Please read the @xref{Members detail} section for details
    * about behavior of different operations.
    *
+   * For each operation, the ordered list of targets which support it
+   * is computed once from the registration masks and the @ref
+   * UserData::support function of targets. The @ref invalidate_routes
+   * function must be called if the set of operations supported by a
+   * target changes after registration.
+   *
    * @example examples/cpp/proxy/dispatchproxy_string.cc:1|2
    */
 
@@ -91,6 +100,21 @@ public:
 	template <class T>
 	void remove_target(T *t);
 
+	/**
+   * This function enables or disables the key cache. When enabled,
+   * the target object which provided a string key on table read is
+   * remembered and queried first on next access with the same key.
+   * This is only suitable when keys do not move between targets
+   * other than through this proxy object.
+   */
+	void set_key_cache(bool enabled);
+
+	/**
+   * This function discards precomputed operations routing and the
+   * key cache. Routes are computed again on next access.
+   */
+	inline void invalidate_routes();
+
 	/** 
    * This function handles the requested operation by relying on the
    * first registered object which @ref UserData::support {supports}
@@ -176,6 +200,7 @@ private:
 		UserData *_ud;
 		Value::Operations _ops;
 		bool _new_keys;
+		Value::Operations _enabled; //< operations both enabled and supported
 	};
 
 	template <class T>
@@ -220,7 +245,20 @@ private:
 
 	friend class ProxyIterator;
 
+	typedef QList<TargetBase *> route_t;
+
+	void build_routes() const;
+	const route_t &get_route(Value::Operation op) const;
+
 	QList<TargetBase *> _targets;
+
+	mutable bool _routes_ready;
+	mutable Value::Operations _supported; //< operations supported by at least one target
+	mutable route_t _routes[16]; //< targets for each operation, indexed by operation bit number
+	mutable route_t _table_route; //< targets for either table read or write
+
+	bool _key_cache_enabled;
+	QHash<String, TargetBase *> _key_cache;
 };
 
 }
@@ -31,6 +31,7 @@ template <class T>
 unsigned int DispatchProxy::add_target(T *t, Value::Operations mask, bool new_keys)
 {
 	_targets.push_back(new Target<T>(t, mask, new_keys));
+	invalidate_routes();
 	return _targets.size() - 1;
 }
 
@@ -39,6 +40,7 @@ unsigned int DispatchProxy::insert_target(T *t, unsigned int pos,
 										  Value::Operations mask, bool new_keys)
 {
 	_targets.insert(pos, new Target<T>(t, mask, new_keys));
+	invalidate_routes();
 	return pos;
 }
 
@@ -53,12 +55,21 @@ void DispatchProxy::remove_target(T *t)
 		else
 			i++;
 	}
+
+	invalidate_routes();
+}
+
+void DispatchProxy::invalidate_routes()
+{
+	_routes_ready = false;
+	_key_cache.clear();
 }
 
 DispatchProxy::TargetBase::TargetBase(UserData *ud, Value::Operations ops, bool new_keys)
 	: _ud(ud)
 	, _ops(ops)
 	, _new_keys(new_keys)
+	, _enabled(0)
 {
 }
 
@@ -58,6 +58,12 @@ namespace QtLua {
    * @ref UserData based object or lua table:
    *
    * @example examples/cpp/value/iterate.cc:3
+   *
+   * The iterator returned by the lua @tt each function fetches up to
+   * 64 entries at once from the C++ iterator. Changes made to the
+   * container from the loop body are not visible for entries which
+   * have already been fetched. Plain lua tables with no metatable
+   * are traversed directly with the lua @tt next function.
    */
 
 class Iterator : public UserData
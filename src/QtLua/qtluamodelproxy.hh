@@ -0,0 +1,144 @@
+/*
+    This file is part of LibQtLua.
+
+    LibQtLua is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibQtLua is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LibQtLua.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright (C) 2008, Alexandre Becoulet <alexandre.becoulet@free.fr>
+
+*/
+
+#ifndef QTLUAMODELPROXY_HH_
+#define QTLUAMODELPROXY_HH_
+
+#include <QObject>
+#include <QPointer>
+#include <QHash>
+#include <QVector>
+#include <QVariant>
+#include <QAbstractItemModel>
+
+#include "qtluauserdata.hh"
+#include "qtluafunction.hh"
+#include "qtluastring.hh"
+
+namespace QtLua {
+
+/**
+   * @short QAbstractItemModel access wrapper for lua script
+   * @header QtLua/ModelProxy
+   * @module {Container proxies}
+   *
+   * This class exposes the top level rows of an attached @ref
+   * QAbstractItemModel object to lua script as a table of rows.
+   *
+   * The @tt{model[row][column]} expression returns the model data
+   * for the given cell. First row and first column have index
+   * 1. Columns may also be designated by their horizontal header
+   * name. Data is read using the default role given to the
+   * constructor. Writing to a cell calls the @ref
+   * QAbstractItemModel::setData function with the same role.
+   *
+   * The @tt{model:rows(first, count, role)} lua method returns a
+   * table of @tt count row tables starting at row @tt first. The
+   * @tt role argument may be either a role number or a role name as
+   * reported by the @ref QAbstractItemModel::roleNames function. All
+   * arguments are optional, a @tt nil count reads all remaining rows.
+   *
+   * Accessing rows past the current row count lets the model fetch
+   * more rows using the @ref QAbstractItemModel::canFetchMore and
+   * @ref QAbstractItemModel::fetchMore functions. Lua operator @tt #
+   * returns the number of rows currently loaded in the model.
+   *
+   * Header names, role names and cells of the last accessed row are
+   * cached. Caches are invalidated when the model reports changes.
+   *
+   * A row object obtained with @tt{model[row]} keeps designating the
+   * same model row when other rows are inserted or removed. It
+   * reads as @tt nil once its own row has been removed.
+   */
+
+class ModelProxy : public QObject,
+				   public UserData
+{
+	Q_OBJECT
+
+public:
+	QTLUA_REFTYPE(ModelProxy)
+
+	/** Create a @ref ModelProxy object with no attached model */
+	ModelProxy(int role = Qt::DisplayRole);
+	/** Create a @ref ModelProxy object and attach given model */
+	ModelProxy(QAbstractItemModel &model, int role = Qt::DisplayRole);
+
+	/** Attach or detach model. argument may be NULL */
+	void set_model(QAbstractItemModel *model);
+
+	Value meta_operation(State *ls, Value::Operation op, const Value &a, const Value &b);
+	Value meta_index(State *ls, const Value &key);
+	bool meta_contains(State *ls, const Value &key);
+	bool support(Value::Operation c) const;
+
+private slots:
+	void data_changed(const QModelIndex &top_left, const QModelIndex &bottom_right);
+	void rows_changed();
+	void header_changed();
+
+private:
+	/**
+   * @short ModelProxy row class
+   * @internal
+   */
+	class Row : public UserData
+	{
+	public:
+		QTLUA_REFTYPE(Row)
+		Row(const Ref<ModelProxy> &proxy, int row);
+
+	private:
+		Value meta_index(State *ls, const Value &key);
+		void meta_newindex(State *ls, const Value &key, const Value &value);
+		Value meta_operation(State *ls, Value::Operation op, const Value &a, const Value &b);
+		bool support(Value::Operation c) const;
+		int get_row() const;
+
+		Ref<ModelProxy> _proxy;
+		QPersistentModelIndex _index; //< follows the row when rows are inserted or removed
+	};
+
+	/**
+   * @short ModelProxy rows method class
+   * @internal
+   */
+	class RowsMethod : public Function
+	{
+		Value::List meta_call(State *ls, const Value::List &args);
+	};
+
+	bool fetch_rows(int count);
+	int get_column(const Value &key);
+	int get_role(const Value &key);
+	const QVariant &get_cell(int row, int column);
+
+	QPointer<QAbstractItemModel> _model;
+	int _role;
+
+	QHash<String, int> _columns; //< horizontal header names
+	QHash<String, int> _roles; //< role names
+	int _cache_row; //< row held in _cache or -1
+	QVector<QVariant> _cache; //< cells of last accessed row
+};
+
+}
+
+#endif
@@ -0,0 +1,192 @@
+/*
+    This file is part of LibQtLua.
+
+    LibQtLua is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibQtLua is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LibQtLua.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright (C) 2008, Alexandre Becoulet <alexandre.becoulet@free.fr>
+
+*/
+
+#ifndef QTLUANUMERICARRAY_HH_
+#define QTLUANUMERICARRAY_HH_
+
+#include <QVector>
+#include <QByteArray>
+
+#include "qtluauserdata.hh"
+#include "qtluafunction.hh"
+
+namespace QtLua {
+
+/**
+   * @short Typed numeric array for lua script
+   * @header QtLua/NumericArray
+   * @module {Container proxies}
+   *
+   * This template class exposes a packed array of numbers to lua
+   * script. Unlike the @ref QVectorProxy class, bulk operations are
+   * performed in C++ on the whole array so that lua scripts do not
+   * have to loop over elements.
+   *
+   * The array either owns its storage or is attached to an existing
+   * C++ container. Storage is a Qt implicitly shared container, so
+   * the @ref set_data and @ref data functions exchange contents with
+   * C++ code without copying elements.
+   *
+   * First entry has index 1. Lua @tt nil value is returned when
+   * reading out of bounds and writing out of bounds raises an
+   * error. Numbers stored in integer arrays saturate to the range
+   * of the element type. Lua operator @tt # returns the element count and lua
+   * operator @tt - returns a lua table copy of the array.
+   *
+   * The following methods are available from lua, @tt x may be
+   * either a number or an other array of the same type and size:
+   *
+   * @list
+   *   @item @tt{a:fill(v)} sets all elements to @tt v.
+   *   @item @tt{a:add(x)}, @tt{a:mul(x)} perform in place element wise operations.
+   *   @item @tt{a:scale(s)} multiplies all elements by @tt s.
+   *   @item @tt{a:axpy(alpha, b)} computes @tt{a = a + alpha * b}.
+   *   @item @tt{a:dot(b)} returns the dot product of @tt a and @tt b.
+   *   @item @tt{a:sum()}, @tt{a:min()} and @tt{a:max()} reduce the array.
+   *   @item @tt{a:clamp(lo, hi)} bounds all elements.
+   *   @item @tt{a:sort()} sorts elements in ascending order.
+   *   @item @tt{a:copy()} returns a new array with the same content.
+   * @end list
+   *
+   * The @ref Float32Array, @ref Float64Array, @ref Int32Array and
+   * @ref UInt8Array types are provided for convenience. Arrays of
+   * these types can be created from lua using the @tt{qt.array}
+   * functions of the @ref QtLib library.
+   */
+
+template <class T, class Container = QVector<T> >
+class NumericArray : public UserData
+{
+public:
+	QTLUA_REFTYPE(NumericArray)
+
+	/** Create an empty @ref NumericArray object which owns its storage */
+	NumericArray();
+	/** Create a @ref NumericArray object which owns @tt size zeroed elements */
+	NumericArray(int size);
+	/** Create a @ref NumericArray object attached to the given container */
+	NumericArray(Container &container);
+
+	/** Attach a container or get back to owned storage if argument is NULL */
+	void set_container(Container *container);
+	/** Replace owned storage with a shallow copy of given container */
+	void set_data(const Container &data);
+	/** Get current storage, may be shared with an other container without copy */
+	inline const Container &data() const;
+
+	/** Get element count */
+	inline int size() const;
+	/** Get pointer to elements, detach shared storage */
+	inline T *elements();
+	/** Get pointer to elements */
+	inline const T *elements() const;
+
+	/** Set all elements to given value */
+	void fill(T value);
+	/** Add given value to all elements */
+	void add(T value);
+	/** Add elements of given array, sizes must match */
+	void add(const NumericArray &array);
+	/** Multiply all elements by given value */
+	void mul(T value);
+	/** Multiply by elements of given array, sizes must match */
+	void mul(const NumericArray &array);
+	/** Multiply all elements by given factor */
+	void scale(double factor);
+	/** Add elements of given array multiplied by @tt alpha */
+	void axpy(double alpha, const NumericArray &array);
+	/** Compute dot product with given array */
+	double dot(const NumericArray &array) const;
+	/** Compute sum of elements */
+	double sum() const;
+	/** Get lowest element, throw if the array is empty */
+	T min() const;
+	/** Get highest element, throw if the array is empty */
+	T max() const;
+	/** Bound all elements to given range */
+	void clamp(T lo, T hi);
+	/** Sort elements in ascending order */
+	void sort();
+
+	/** Convert a number to the element type, integer types saturate */
+	static T from_number(double n);
+
+	Value meta_operation(State *ls, Value::Operation op, const Value &a, const Value &b);
+	Value meta_index(State *ls, const Value &key);
+	void meta_newindex(State *ls, const Value &key, const Value &value);
+	bool meta_contains(State *ls, const Value &key);
+	bool support(Value::Operation c) const;
+
+private:
+	String get_type_name() const;
+
+	void check_size(const NumericArray &array) const;
+	static Value to_value(State *ls, T value);
+
+	/** Lua callable methods */
+	enum MethodId
+	{
+		MethodFill,
+		MethodAdd,
+		MethodMul,
+		MethodScale,
+		MethodAxpy,
+		MethodDot,
+		MethodSum,
+		MethodMin,
+		MethodMax,
+		MethodClamp,
+		MethodSort,
+		MethodCopy
+	};
+
+	/**
+   * @short NumericArray lua method class
+   * @internal
+   */
+	class ArrayMethod : public Function
+	{
+	public:
+		ArrayMethod(MethodId id);
+
+	private:
+		Value::List meta_call(State *ls, const Value::List &args);
+
+		MethodId _id;
+	};
+
+	static Value get_method(State *ls, const String &name);
+
+	Container _own;
+	Container *_container;
+};
+
+/** Array of single precision floats, shares storage with @tt QVector<float> */
+typedef NumericArray<float> Float32Array;
+/** Array of double precision floats, shares storage with @tt QVector<double> */
+typedef NumericArray<double> Float64Array;
+/** Array of 32 bits integers, shares storage with @tt QVector<qint32> */
+typedef NumericArray<qint32> Int32Array;
+/** Array of bytes, shares storage with @tt QByteArray */
+typedef NumericArray<quint8, QByteArray> UInt8Array;
+
+}
+
+#endif
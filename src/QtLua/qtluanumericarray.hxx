@@ -0,0 +1,530 @@
+/*
+    This file is part of LibQtLua.
+
+    LibQtLua is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibQtLua is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LibQtLua.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright (C) 2008, Alexandre Becoulet <alexandre.becoulet@free.fr>
+
+*/
+
+#ifndef QTLUANUMERICARRAY_HXX_
+#define QTLUANUMERICARRAY_HXX_
+
+#include <algorithm>
+#include <limits>
+
+#include "qtluanumericarray.hh"
+#include "qtluauserdata.hxx"
+#include "qtluafunction.hxx"
+
+namespace QtLua {
+
+/*
+  Element wise loops below work on raw pointers with no function
+  call or aliasing between input and output elements, so that the
+  compiler is able to vectorize them. Reductions are split across
+  four accumulators to break the dependency chain.
+*/
+
+template <class T, class Container>
+NumericArray<T, Container>::NumericArray()
+	: _container(&_own)
+{
+}
+
+template <class T, class Container>
+NumericArray<T, Container>::NumericArray(int size)
+	: _container(&_own)
+{
+	_own.resize(size);
+	fill(0);
+}
+
+template <class T, class Container>
+NumericArray<T, Container>::NumericArray(Container &container)
+	: _container(&container)
+{
+}
+
+template <class T, class Container>
+void NumericArray<T, Container>::set_container(Container *container)
+{
+	_container = container ? container : &_own;
+}
+
+template <class T, class Container>
+void NumericArray<T, Container>::set_data(const Container &data)
+{
+	_own = data;
+	_container = &_own;
+}
+
+template <class T, class Container>
+const Container &NumericArray<T, Container>::data() const
+{
+	return *_container;
+}
+
+template <class T, class Container>
+int NumericArray<T, Container>::size() const
+{
+	return _container->size();
+}
+
+template <class T, class Container>
+T *NumericArray<T, Container>::elements()
+{
+	return reinterpret_cast<T *>(_container->data());
+}
+
+template <class T, class Container>
+const T *NumericArray<T, Container>::elements() const
+{
+	return reinterpret_cast<const T *>(_container->constData());
+}
+
+template <class T, class Container>
+void NumericArray<T, Container>::check_size(const NumericArray &array) const
+{
+	if (array.size() != size())
+		QTLUA_THROW(QtLua::NumericArray, "Array size mismatch, % elements expected instead of %.",
+					.arg(size()).arg(array.size()));
+}
+
+template <class T, class Container>
+void NumericArray<T, Container>::fill(T value)
+{
+	int n = size();
+	T *d = elements();
+
+	for (int i = 0; i < n; i++)
+		d[i] = value;
+}
+
+template <class T, class Container>
+void NumericArray<T, Container>::add(T value)
+{
+	int n = size();
+	T *d = elements();
+
+	// signed integer overflow is undefined, saturate instead
+	if (std::numeric_limits<T>::is_integer)
+		for (int i = 0; i < n; i++)
+			d[i] = from_number((double)d[i] + value);
+	else
+		for (int i = 0; i < n; i++)
+			d[i] += value;
+}
+
+template <class T, class Container>
+void NumericArray<T, Container>::add(const NumericArray &array)
+{
+	check_size(array);
+
+	int n = size();
+	const T *s = array.elements();
+	T *d = elements();
+
+	if (std::numeric_limits<T>::is_integer)
+		for (int i = 0; i < n; i++)
+			d[i] = from_number((double)d[i] + s[i]);
+	else
+		for (int i = 0; i < n; i++)
+			d[i] += s[i];
+}
+
+template <class T, class Container>
+void NumericArray<T, Container>::mul(T value)
+{
+	int n = size();
+	T *d = elements();
+
+	// signed integer overflow is undefined, saturate instead
+	if (std::numeric_limits<T>::is_integer)
+		for (int i = 0; i < n; i++)
+			d[i] = from_number((double)d[i] * value);
+	else
+		for (int i = 0; i < n; i++)
+			d[i] *= value;
+}
+
+template <class T, class Container>
+void NumericArray<T, Container>::mul(const NumericArray &array)
+{
+	check_size(array);
+
+	int n = size();
+	const T *s = array.elements();
+	T *d = elements();
+
+	if (std::numeric_limits<T>::is_integer)
+		for (int i = 0; i < n; i++)
+			d[i] = from_number((double)d[i] * s[i]);
+	else
+		for (int i = 0; i < n; i++)
+			d[i] *= s[i];
+}
+
+template <class T, class Container>
+void NumericArray<T, Container>::scale(double factor)
+{
+	int n = size();
+	T *d = elements();
+
+	for (int i = 0; i < n; i++)
+		d[i] = from_number(d[i] * factor);
+}
+
+template <class T, class Container>
+void NumericArray<T, Container>::axpy(double alpha, const NumericArray &array)
+{
+	check_size(array);
+
+	int n = size();
+	const T *s = array.elements();
+	T *d = elements();
+
+	for (int i = 0; i < n; i++)
+		d[i] = from_number(d[i] + alpha * s[i]);
+}
+
+template <class T, class Container>
+double NumericArray<T, Container>::dot(const NumericArray &array) const
+{
+	check_size(array);
+
+	int n = size(), i = 0;
+	const T *a = elements();
+	const T *b = array.elements();
+	double r0 = 0, r1 = 0, r2 = 0, r3 = 0;
+
+	for (; i + 4 <= n; i += 4)
+	{
+		r0 += (double)a[i] * b[i];
+		r1 += (double)a[i + 1] * b[i + 1];
+		r2 += (double)a[i + 2] * b[i + 2];
+		r3 += (double)a[i + 3] * b[i + 3];
+	}
+	for (; i < n; i++)
+		r0 += (double)a[i] * b[i];
+
+	return (r0 + r1) + (r2 + r3);
+}
+
+template <class T, class Container>
+double NumericArray<T, Container>::sum() const
+{
+	int n = size(), i = 0;
+	const T *a = elements();
+	double r0 = 0, r1 = 0, r2 = 0, r3 = 0;
+
+	for (; i + 4 <= n; i += 4)
+	{
+		r0 += a[i];
+		r1 += a[i + 1];
+		r2 += a[i + 2];
+		r3 += a[i + 3];
+	}
+	for (; i < n; i++)
+		r0 += a[i];
+
+	return (r0 + r1) + (r2 + r3);
+}
+
+template <class T, class Container>
+T NumericArray<T, Container>::min() const
+{
+	int n = size();
+
+	if (!n)
+		QTLUA_THROW(QtLua::NumericArray, "Can not get the lowest element of an empty array.");
+
+	const T *a = elements();
+	T r = a[0];
+
+	for (int i = 1; i < n; i++)
+		r = a[i] < r ? a[i] : r;
+
+	return r;
+}
+
+template <class T, class Container>
+T NumericArray<T, Container>::max() const
+{
+	int n = size();
+
+	if (!n)
+		QTLUA_THROW(QtLua::NumericArray, "Can not get the highest element of an empty array.");
+
+	const T *a = elements();
+	T r = a[0];
+
+	for (int i = 1; i < n; i++)
+		r = a[i] > r ? a[i] : r;
+
+	return r;
+}
+
+template <class T, class Container>
+void NumericArray<T, Container>::clamp(T lo, T hi)
+{
+	int n = size();
+	T *d = elements();
+
+	for (int i = 0; i < n; i++)
+	{
+		T v = d[i] < lo ? lo : d[i];
+		d[i] = v > hi ? hi : v;
+	}
+}
+
+template <class T, class Container>
+void NumericArray<T, Container>::sort()
+{
+	T *d = elements();
+
+	std::sort(d, d + size());
+}
+
+template <class T, class Container>
+Value NumericArray<T, Container>::to_value(State *ls, T value)
+{
+	if (std::numeric_limits<T>::is_integer)
+		return Value(ls, (int)value);
+	else
+		return Value(ls, (double)value);
+}
+
+template <class T, class Container>
+T NumericArray<T, Container>::from_number(double n)
+{
+	// converting an out of range double to an integer type is undefined
+	if (std::numeric_limits<T>::is_integer)
+	{
+		if (n != n)
+			return 0;
+		if (n <= (double)std::numeric_limits<T>::min())
+			return std::numeric_limits<T>::min();
+		if (n >= (double)std::numeric_limits<T>::max())
+			return std::numeric_limits<T>::max();
+	}
+
+	return (T)n;
+}
+
+template <class T, class Container>
+Value NumericArray<T, Container>::meta_index(State *ls, const Value &key)
+{
+	if (key.type() == Value::TString)
+		return get_method(ls, key.to_string());
+
+	int index = (unsigned int)key.to_number() - 1;
+
+	if (index >= 0 && index < size())
+		return to_value(ls, elements()[index]);
+	else
+		return Value(ls);
+}
+
+template <class T, class Container>
+void NumericArray<T, Container>::meta_newindex(State *ls, const Value &key, const Value &value)
+{
+	Q_UNUSED(ls)
+
+	int index = (unsigned int)key.to_number() - 1;
+
+	if (index < 0 || index >= size())
+		QTLUA_THROW(QtLua::NumericArray, "Index '%' is out of bounds.", .arg(index + 1));
+
+	elements()[index] = from_number(value.to_number());
+}
+
+template <class T, class Container>
+bool NumericArray<T, Container>::meta_contains(State *ls, const Value &key)
+{
+	Q_UNUSED(ls)
+	try
+	{
+		int index = (unsigned int)key.to_number() - 1;
+
+		return index >= 0 && index < size();
+	}
+	catch (String &e)
+	{
+		return false;
+	}
+}
+
+template <class T, class Container>
+Value NumericArray<T, Container>::meta_operation(State *ls, Value::Operation op, const Value &a, const Value &b)
+{
+	switch (op)
+	{
+	case Value::OpLen:
+		return Value(ls, size());
+	case Value::OpUnm:
+		return Value(ls, (unsigned int)size(), elements());
+	default:
+		return UserData::meta_operation(ls, op, a, b);
+	}
+}
+
+template <class T, class Container>
+bool NumericArray<T, Container>::support(Value::Operation c) const
+{
+	switch (c)
+	{
+	case Value::OpIndex:
+	case Value::OpNewindex:
+	case Value::OpLen:
+	case Value::OpUnm:
+		return true;
+	default:
+		return false;
+	}
+}
+
+template <class T, class Container>
+String NumericArray<T, Container>::get_type_name() const
+{
+	return type_name<NumericArray>();
+}
+
+template <class T, class Container>
+Value NumericArray<T, Container>::get_method(State *ls, const String &name)
+{
+	static ArrayMethod fill_(MethodFill);
+	static ArrayMethod add_(MethodAdd);
+	static ArrayMethod mul_(MethodMul);
+	static ArrayMethod scale_(MethodScale);
+	static ArrayMethod axpy_(MethodAxpy);
+	static ArrayMethod dot_(MethodDot);
+	static ArrayMethod sum_(MethodSum);
+	static ArrayMethod min_(MethodMin);
+	static ArrayMethod max_(MethodMax);
+	static ArrayMethod clamp_(MethodClamp);
+	static ArrayMethod sort_(MethodSort);
+	static ArrayMethod copy_(MethodCopy);
+
+	if (name == "fill")
+		return Value(ls, fill_);
+	else if (name == "add")
+		return Value(ls, add_);
+	else if (name == "mul")
+		return Value(ls, mul_);
+	else if (name == "scale")
+		return Value(ls, scale_);
+	else if (name == "axpy")
+		return Value(ls, axpy_);
+	else if (name == "dot")
+		return Value(ls, dot_);
+	else if (name == "sum")
+		return Value(ls, sum_);
+	else if (name == "min")
+		return Value(ls, min_);
+	else if (name == "max")
+		return Value(ls, max_);
+	else if (name == "clamp")
+		return Value(ls, clamp_);
+	else if (name == "sort")
+		return Value(ls, sort_);
+	else if (name == "copy")
+		return Value(ls, copy_);
+
+	return Value(ls);
+}
+
+template <class T, class Container>
+NumericArray<T, Container>::ArrayMethod::ArrayMethod(MethodId id)
+	: _id(id)
+{
+}
+
+template <class T, class Container>
+Value::List NumericArray<T, Container>::ArrayMethod::meta_call(State *ls, const Value::List &args)
+{
+	typename NumericArray::ptr self = get_arg_ud<NumericArray>(args, 0);
+
+	switch (_id)
+	{
+	case MethodFill:
+		self->fill(from_number(get_arg<double>(args, 1)));
+		break;
+
+	case MethodAdd:
+	case MethodMul:
+	{
+		const Value &x = get_arg<const Value &>(args, 1);
+
+		if (x.type() == Value::TNumber)
+		{
+			if (_id == MethodAdd)
+				self->add(from_number(x.to_number()));
+			else
+				self->mul(from_number(x.to_number()));
+		}
+		else
+		{
+			typename NumericArray::ptr a = x.to_userdata_cast<NumericArray>();
+
+			if (_id == MethodAdd)
+				self->add(*a);
+			else
+				self->mul(*a);
+		}
+		break;
+	}
+
+	case MethodScale:
+		self->scale(get_arg<double>(args, 1));
+		break;
+
+	case MethodAxpy:
+		self->axpy(get_arg<double>(args, 1), *get_arg_ud<NumericArray>(args, 2));
+		break;
+
+	case MethodDot:
+		return Value(ls, self->dot(*get_arg_ud<NumericArray>(args, 1)));
+
+	case MethodSum:
+		return Value(ls, self->sum());
+
+	case MethodMin:
+		return self->size() ? to_value(ls, self->min()) : Value(ls);
+
+	case MethodMax:
+		return self->size() ? to_value(ls, self->max()) : Value(ls);
+
+	case MethodClamp:
+		self->clamp(from_number(get_arg<double>(args, 1)), from_number(get_arg<double>(args, 2)));
+		break;
+
+	case MethodSort:
+		self->sort();
+		break;
+
+	case MethodCopy:
+	{
+		typename NumericArray::ptr copy = QTLUA_REFNEW(NumericArray);
+		copy->set_data(self->data());
+		return Value(ls, copy);
+	}
+	}
+
+	return Value::List();
+}
+
+}
+
+#endif
@@ -0,0 +1,112 @@
+/*
+    This file is part of LibQtLua.
+
+    LibQtLua is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibQtLua is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LibQtLua.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright (C) 2008, Alexandre Becoulet <alexandre.becoulet@free.fr>
+
+*/
+
+#ifndef QTLUAPENDING_HH_
+#define QTLUAPENDING_HH_
+
+#include <QObject>
+#include <QPointer>
+
+#include "qtluavalue.hh"
+
+namespace QtLua {
+
+class State;
+class UserData;
+class Scheduler;
+
+/**
+   * @short Suspended coroutine resume handle
+   * @header QtLua/Pending
+   * @module {Base}
+   *
+   * This class allows a C++ function invoked from a lua coroutine to
+   * complete asynchronously. A @ref Pending object is returned by the
+   * @ref UserData::suspend function when called from the @ref
+   * UserData::meta_call function. The calling lua coroutine is
+   * suspended when the @ref UserData::meta_call function returns.
+   *
+   * The coroutine is resumed from the Qt event loop once the @ref
+   * resume or @ref fail function has been called. Values passed to
+   * the @ref resume function are returned to the lua caller. The @ref
+   * resume_on function can be used to resume the coroutine when a Qt
+   * signal is emitted, a @ref QFutureWatcher @tt finished signal for
+   * instance.
+   *
+   * When the @ref fail function is used, a lua error is raised in the
+   * resumed coroutine.
+   *
+   * The @ref Pending object is owned by the @ref State object and is
+   * deleted once the coroutine has been resumed. When the coroutine
+   * is a @ref Scheduler task, the task is handed back to the
+   * scheduler which resumes it on its next run.
+   *
+   * @example examples/cpp/userdata/async.cc:1
+   */
+class Pending : public QObject
+{
+	Q_OBJECT
+
+	friend class UserData;
+	friend class State;
+	friend class Scheduler;
+
+	Pending(State *ls, const Value &thread);
+
+public:
+	/** Resume suspended coroutine from event loop, given values are
+      returned to the lua caller. */
+	void resume(const Value::List &results);
+
+	/** Resume suspended coroutine from event loop and report an error
+      to the lua caller. */
+	void fail(const String &error);
+
+	/** Resume suspended coroutine without return value when the given
+      Qt signal is emitted. */
+	void resume_on(QObject *sender, const char *signal);
+
+	/** @This returns the associated @ref State object. */
+	inline State *get_state() const;
+
+	/** @This returns true if the @ref resume or @ref fail function has
+      already been called. */
+	inline bool is_done() const;
+
+public slots:
+	/** Resume suspended coroutine without return value. */
+	void resume();
+
+private slots:
+	void deliver();
+
+private:
+	QPointer<State> _ls;
+	Value _thread;
+	Value::List _results;
+	bool _error;
+	bool _done;
+	QPointer<Scheduler> _sched; //< scheduler of the suspended task
+	int _task;
+};
+
+}
+
+#endif
@@ -0,0 +1,136 @@
+/*
+    This file is part of LibQtLua.
+
+    LibQtLua is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibQtLua is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LibQtLua.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright (C) 2008, Alexandre Becoulet <alexandre.becoulet@free.fr>
+
+*/
+
+#ifndef QTLUAPROXYNOTIFIER_HH_
+#define QTLUAPROXYNOTIFIER_HH_
+
+#include <QObject>
+#include <QList>
+#include <QHash>
+
+#include "qtluavalue.hh"
+
+namespace QtLua {
+
+/**
+   * @short Container proxy change notifier
+   * @header QtLua/ProxyNotifier
+   * @module {Container proxies}
+   *
+   * This class reports changes made to a container exposed by a @ref
+   * QVectorProxy, @ref QListProxy or @ref QHashProxy object. A
+   * notifier is created on first call to the @tt notifier function
+   * of the proxy. Changes made through the proxy are reported
+   * automatically and changes made to the container from C++ code
+   * can be reported using the @ref notify_changed functions.
+   *
+   * Changes are not reported immediately but accumulated and
+   * delivered from the Qt event loop, so that observers are invoked
+   * once per event loop turn with the list of changes. Adjacent
+   * changes of the same type on index ranges are merged and all
+   * changes of a key are combined in a single record, which is
+   * dropped when the key is inserted then removed. No change is
+   * recorded while no observer is registered.
+   *
+   * C++ observers connect to the @ref changed signal. Lua functions
+   * registered with the @tt{proxy:observe(func)} method of the proxy
+   * are called with a table of change records. Each record has a
+   * @tt type field set to @tt "set", @tt "insert" or @tt "remove"
+   * and either @tt first and @tt last index fields or a @tt key
+   * field for associative containers. The @tt{proxy:unobserve(func)}
+   * method removes a lua observer.
+   *
+   * Lua observers are held by the notifier. A lua function which
+   * refers to its own proxy therefore keeps the proxy alive, because
+   * the lua garbage collector does not see through this C++ reference.
+   * Such observers must be removed with @tt unobserve before the
+   * proxy can be collected.
+   *
+   * The notifier is deleted along with its proxy. When this happens
+   * from an observer call, remaining observers are skipped and the
+   * deletion is deferred to the event loop which is delivering.
+   */
+class ProxyNotifier : public QObject
+{
+	Q_OBJECT
+
+public:
+	/** Container change types */
+	enum ChangeType
+	{
+		ChangeSet,
+		ChangeInsert,
+		ChangeRemove
+	};
+
+	/** Container change record */
+	struct Change
+	{
+		ChangeType _type;
+		int _first; //< first changed index, 0 for keyed changes
+		int _last; //< last changed index, 0 for keyed changes
+		Value _key; //< changed key for associative containers
+	};
+
+	typedef QList<Change> ChangeList;
+
+	/** Create a @ref ProxyNotifier object */
+	ProxyNotifier(QObject *parent = 0);
+
+	/** Delete the notifier, deferred if observers are being called */
+	void destroy();
+
+	/** Register a lua function called with batched changes */
+	void add_observer(const Value &func);
+	/** Unregister a lua function */
+	void remove_observer(const Value &func);
+
+	/** @This returns true if either lua or C++ observers are registered. */
+	bool is_observed() const;
+
+	/** Report a change on entries from index @tt first to @tt last,
+      first entry has index 1. */
+	void notify_changed(int first, int last, ChangeType type = ChangeSet);
+	/** Report a change on entry with given key. */
+	void notify_changed(const Value &key, ChangeType type = ChangeSet);
+
+signals:
+	/** Emitted from the event loop with changes accumulated since last emission. */
+	void changed(const QtLua::ProxyNotifier::ChangeList &changes);
+
+private slots:
+	void deliver();
+
+private:
+	void post(const Change &change);
+	static bool merge(Change &prev, const Change &change);
+	static Value to_table(State *ls, const ChangeList &changes);
+
+	Value::List _observers;
+	ChangeList _pending;
+	QHash<Value, int> _pending_keys; //< index of the pending record of each changed key
+	bool _posted;
+	int _delivering; //< nested deliver() calls
+	bool _destroyed;
+};
+
+}
+
+#endif
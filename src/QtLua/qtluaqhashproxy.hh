@@ -22,9 +22,12 @@
 #define QTLUAQHASHPROXY_HH_
 
 #include <QPointer>
+#include <QMap>
 
 #include "qtluauserdata.hh"
 #include "qtluaiterator.hh"
+#include "qtluafunction.hh"
+#include "qtluaproxynotifier.hh"
 
 namespace QtLua {
 
@@ -42,6 +45,35 @@ struct QHashProxyKeytype<String>
 	static inline void completion_patch(String &path, String &entry, int &offset);
 };
 
+/** @module {Container proxies} @internal */
+template <typename T>
+struct QHashProxyOrder
+{
+	enum { ordered = 0 };
+
+	static inline void range(const T &c, const Value *lo, const Value *hi,
+							 typename T::const_iterator &begin, typename T::const_iterator &end);
+	static inline typename T::const_iterator lower_bound(const T &c, const Value &key);
+	static inline typename T::const_iterator upper_bound(const T &c, const Value &key);
+	static inline typename T::const_iterator first(const T &c);
+	static inline typename T::const_iterator last(const T &c);
+};
+
+/** @module {Container proxies} @internal */
+template <typename Key, typename Val>
+struct QHashProxyOrder<QMap<Key, Val> >
+{
+	enum { ordered = 1 };
+
+	static inline void range(const QMap<Key, Val> &c, const Value *lo, const Value *hi,
+							 typename QMap<Key, Val>::const_iterator &begin,
+							 typename QMap<Key, Val>::const_iterator &end);
+	static inline typename QMap<Key, Val>::const_iterator lower_bound(const QMap<Key, Val> &c, const Value &key);
+	static inline typename QMap<Key, Val>::const_iterator upper_bound(const QMap<Key, Val> &c, const Value &key);
+	static inline typename QMap<Key, Val>::const_iterator first(const QMap<Key, Val> &c);
+	static inline typename QMap<Key, Val>::const_iterator last(const QMap<Key, Val> &c);
+};
+
 /**
    * @short QHash and QMap read only access wrapper for lua script
    * @header QtLua/QHashProxy
@@ -51,6 +83,29 @@ struct QHashProxyKeytype<String>
    * or @ref QMap container object to lua script for read access. The
    * @ref QHashProxy class may be used for read/write access.
    *
+   * When a @ref QMap container is attached, the following lua
+   * methods are available to query ordered ranges of keys. Bounds are
+   * inclusive and a @tt nil bound leaves the range open:
+   *
+   * @list
+   *   @item @tt{proxy:range(lo, hi)} returns a table of keys and a
+   *     table of values for entries in range.
+   *   @item @tt{proxy:count_range(lo, hi)} returns the number of
+   *     entries in range.
+   *   @item @tt{proxy:lower_bound(key)} and @tt{proxy:upper_bound(key)}
+   *     return the key and value of the first entry with a key
+   *     greater or equal, respectively greater, than the given key.
+   *   @item @tt{proxy:first()} and @tt{proxy:last()} return the
+   *     key and value of the lowest and highest entries.
+   * @end list
+   *
+   * Lua functions registered with the @tt{proxy:observe(func)}
+   * method are told about changes to the container, see @ref
+   * ProxyNotifier.
+   *
+   * Container entries take precedence over lua methods when keys
+   * are strings.
+   *
    * See @ref QHashProxy class documentation for details and examples.
    */
 
@@ -65,9 +120,15 @@ public:
 	/** Create a @ref QHashProxy object and attach given container */
 	QHashProxyRo(Container &hash);
 
+	~QHashProxyRo();
+
 	/** Attach or detach container. argument may be NULL */
 	void set_container(Container *hash);
 
+	/** Get change notifier of this proxy, created on first call. See
+      @ref ProxyNotifier for details. */
+	ProxyNotifier &notifier();
+
 	Value meta_index(State *ls, const Value &key);
 	bool meta_contains(State *ls, const Value &key);
 	Ref<Iterator> new_iterator(State *ls);
@@ -78,6 +139,38 @@ private:
 	void completion_patch(String &path, String &entry, int &offset);
 	String get_type_name() const;
 
+	typedef QHashProxyOrder<Container> order_t;
+
+	/** Lua callable methods */
+	enum MethodId
+	{
+		MethodRange,
+		MethodCountRange,
+		MethodLowerBound,
+		MethodUpperBound,
+		MethodFirst,
+		MethodLast,
+		MethodObserve,
+		MethodUnobserve
+	};
+
+	/**
+   * @short QHashProxyRo lua method class
+   * @internal
+   */
+	class ProxyMethod : public Function
+	{
+	public:
+		ProxyMethod(MethodId id);
+
+	private:
+		Value::List meta_call(State *ls, const Value::List &args);
+
+		MethodId _id;
+	};
+
+	Value get_method(State *ls, const Value &key);
+
 	/**
    * @short QHashProxyRo iterator class
    * @internal
@@ -101,8 +194,12 @@ private:
 	};
 
 protected:
+	/** Report change on entry with given key if observed */
+	inline void notify(ProxyNotifier::ChangeType type, const Value &key);
+
 	/** @internal */
 	Container *_hash;
+	ProxyNotifier *_notifier;
 };
 
 /**
@@ -24,21 +24,31 @@
 #include "qtluaqhashproxy.hh"
 #include "qtluauserdata.hxx"
 #include "qtluaiterator.hxx"
+#include "qtluafunction.hxx"
 
 namespace QtLua {
 
 template <class Container>
 QHashProxyRo<Container>::QHashProxyRo()
 	: _hash(0)
+	, _notifier(0)
 {
 }
 
 template <class Container>
 QHashProxyRo<Container>::QHashProxyRo(Container &hash)
 	: _hash(&hash)
+	, _notifier(0)
 {
 }
 
+template <class Container>
+QHashProxyRo<Container>::~QHashProxyRo()
+{
+	if (_notifier)
+		_notifier->destroy();
+}
+
 template <class Container>
 QHashProxy<Container>::QHashProxy()
 	: QHashProxyRo<Container>()
@@ -57,12 +67,35 @@ void QHashProxyRo<Container>::set_container(Container *hash)
 	_hash = hash;
 }
 
+template <class Container>
+ProxyNotifier &QHashProxyRo<Container>::notifier()
+{
+	if (!_notifier)
+		_notifier = new ProxyNotifier();
+	return *_notifier;
+}
+
+template <class Container>
+void QHashProxyRo<Container>::notify(ProxyNotifier::ChangeType type, const Value &key)
+{
+	if (_notifier)
+		_notifier->notify_changed(key, type);
+}
+
 template <class Container>
 Value QHashProxyRo<Container>::meta_index(State *ls, const Value &key)
 {
 	if (!_hash)
 		return Value(ls);
 
+	if (key.type() == Value::TString)
+	{
+		Value method = get_method(ls, key);
+
+		if (!method.is_nil())
+			return method;
+	}
+
 	typename Container::iterator i = _hash->find(key);
 
 	if (i == _hash->end())
@@ -131,9 +164,18 @@ void QHashProxy<Container>::meta_newindex(State *ls, const Value &key, const Val
 		QTLUA_THROW(QtLua::QHashProxy, "Can not index a null container.");
 
 	else if (value.type() == Value::TNil)
-		_hash->remove(key);
+	{
+		if (_hash->remove(key))
+			this->notify(ProxyNotifier::ChangeRemove, key);
+	}
 	else
+	{
+		int size = _hash->size();
+
 		_hash->insert(key, value);
+		this->notify(size == _hash->size() ? ProxyNotifier::ChangeSet
+					 : ProxyNotifier::ChangeInsert, key);
+	}
 }
 
 template <class Container>
@@ -183,6 +225,224 @@ ValueRef QHashProxyRo<Container>::ProxyIterator::get_value_ref()
 	return ValueRef(Value(_ls, _proxy), Value(_ls, _it.key()));
 }
 
+template <class Container>
+Value QHashProxyRo<Container>::get_method(State *ls, const Value &key)
+{
+	static ProxyMethod range_(MethodRange);
+	static ProxyMethod count_range_(MethodCountRange);
+	static ProxyMethod lower_bound_(MethodLowerBound);
+	static ProxyMethod upper_bound_(MethodUpperBound);
+	static ProxyMethod first_(MethodFirst);
+	static ProxyMethod last_(MethodLast);
+	static ProxyMethod observe_(MethodObserve);
+	static ProxyMethod unobserve_(MethodUnobserve);
+
+	String name(key.to_string());
+	ProxyMethod *m;
+
+	if (name == "observe")
+		m = &observe_;
+	else if (name == "unobserve")
+		m = &unobserve_;
+	else if (!order_t::ordered)
+		return Value(ls);
+	else if (name == "range")
+		m = &range_;
+	else if (name == "count_range")
+		m = &count_range_;
+	else if (name == "lower_bound")
+		m = &lower_bound_;
+	else if (name == "upper_bound")
+		m = &upper_bound_;
+	else if (name == "first")
+		m = &first_;
+	else if (name == "last")
+		m = &last_;
+	else
+		return Value(ls);
+
+	// container entries shadow methods
+	try
+	{
+		if (_hash->contains(key))
+			return Value(ls);
+	}
+	catch (String &e)
+	{
+	}
+
+	return Value(ls, *m);
+}
+
+template <class Container>
+QHashProxyRo<Container>::ProxyMethod::ProxyMethod(MethodId id)
+	: _id(id)
+{
+}
+
+template <class Container>
+Value::List QHashProxyRo<Container>::ProxyMethod::meta_call(State *ls, const Value::List &args)
+{
+	typename QHashProxyRo::ptr self = get_arg_ud<QHashProxyRo>(args, 0);
+
+	switch (_id)
+	{
+	case MethodObserve:
+		meta_call_check_args(args, 2, 2, Value::TUserData, Value::TFunction);
+		self->notifier().add_observer(args[1]);
+		return Value::List();
+
+	case MethodUnobserve:
+		meta_call_check_args(args, 2, 2, Value::TUserData, Value::TFunction);
+		if (self->_notifier)
+			self->_notifier->remove_observer(args[1]);
+		return Value::List();
+
+	default:
+		break;
+	}
+
+	const Container *map = self->_hash;
+
+	if (!map)
+		QTLUA_THROW(QtLua::QHashProxy, "Can not query a null container.");
+
+	typename Container::const_iterator b, e;
+
+	switch (_id)
+	{
+	case MethodRange:
+	case MethodCountRange:
+	{
+		const Value *lo = args.size() > 1 && !args[1].is_nil() ? &args[1] : 0;
+		const Value *hi = args.size() > 2 && !args[2].is_nil() ? &args[2] : 0;
+		order_t::range(*map, lo, hi, b, e);
+
+		if (_id == MethodCountRange)
+		{
+			int count = 0;
+			for (; b != e; ++b)
+				count++;
+			return Value(ls, count);
+		}
+
+		Value::List keys, values;
+		for (; b != e; ++b)
+		{
+			keys.push_back(Value(ls, b.key()));
+			values.push_back(Value(ls, b.value()));
+		}
+
+		Value key_table(Value::new_table(ls, keys.size()));
+		Value value_table(Value::new_table(ls, values.size()));
+		key_table.table_raw_set(1, keys);
+		value_table.table_raw_set(1, values);
+		return Value::List(key_table, value_table);
+	}
+
+	case MethodLowerBound:
+		b = order_t::lower_bound(*map, get_arg<const Value &>(args, 1));
+		break;
+
+	case MethodUpperBound:
+		b = order_t::upper_bound(*map, get_arg<const Value &>(args, 1));
+		break;
+
+	case MethodFirst:
+		b = order_t::first(*map);
+		break;
+
+	case MethodLast:
+		b = order_t::last(*map);
+		break;
+
+	default:
+		return Value::List();
+	}
+
+	if (b == map->constEnd())
+		return Value(ls);
+
+	return Value::List(Value(ls, b.key()), Value(ls, b.value()));
+}
+
+template <typename T>
+void QHashProxyOrder<T>::range(const T &c, const Value *lo, const Value *hi,
+							   typename T::const_iterator &begin, typename T::const_iterator &end)
+{
+	Q_UNUSED(lo)
+	Q_UNUSED(hi)
+	begin = end = c.constEnd();
+}
+
+template <typename T>
+typename T::const_iterator QHashProxyOrder<T>::lower_bound(const T &c, const Value &key)
+{
+	Q_UNUSED(key)
+	return c.constEnd();
+}
+
+template <typename T>
+typename T::const_iterator QHashProxyOrder<T>::upper_bound(const T &c, const Value &key)
+{
+	Q_UNUSED(key)
+	return c.constEnd();
+}
+
+template <typename T>
+typename T::const_iterator QHashProxyOrder<T>::first(const T &c)
+{
+	return c.constEnd();
+}
+
+template <typename T>
+typename T::const_iterator QHashProxyOrder<T>::last(const T &c)
+{
+	return c.constEnd();
+}
+
+template <typename Key, typename Val>
+void QHashProxyOrder<QMap<Key, Val> >::range(const QMap<Key, Val> &c, const Value *lo, const Value *hi,
+											 typename QMap<Key, Val>::const_iterator &begin,
+											 typename QMap<Key, Val>::const_iterator &end)
+{
+	begin = lo ? lower_bound(c, *lo) : c.constBegin();
+	end = hi ? upper_bound(c, *hi) : c.constEnd();
+
+	// empty range when bounds are swapped
+	if (end != c.constEnd() && (begin == c.constEnd() || end.key() < begin.key()))
+		end = begin;
+}
+
+template <typename Key, typename Val>
+typename QMap<Key, Val>::const_iterator QHashProxyOrder<QMap<Key, Val> >::lower_bound(const QMap<Key, Val> &c, const Value &key)
+{
+	return c.lowerBound(key);
+}
+
+template <typename Key, typename Val>
+typename QMap<Key, Val>::const_iterator QHashProxyOrder<QMap<Key, Val> >::upper_bound(const QMap<Key, Val> &c, const Value &key)
+{
+	return c.upperBound(key);
+}
+
+template <typename Key, typename Val>
+typename QMap<Key, Val>::const_iterator QHashProxyOrder<QMap<Key, Val> >::first(const QMap<Key, Val> &c)
+{
+	return c.constBegin();
+}
+
+template <typename Key, typename Val>
+typename QMap<Key, Val>::const_iterator QHashProxyOrder<QMap<Key, Val> >::last(const QMap<Key, Val> &c)
+{
+	typename QMap<Key, Val>::const_iterator i = c.constEnd();
+
+	if (i != c.constBegin())
+		--i;
+
+	return i;
+}
+
 template <typename T>
 void QHashProxyKeytype<T>::completion_patch(String &path, String &entry, int &offset)
 {
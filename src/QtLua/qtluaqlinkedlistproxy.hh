@@ -25,6 +25,7 @@
 
 #include "qtluauserdata.hh"
 #include "qtluaiterator.hh"
+#include "qtluafunction.hh"
 
 namespace QtLua {
 
@@ -36,6 +37,22 @@ namespace QtLua {
    * This template class may be used to iterate over an attached @ref QLinkedList
    * container object from lua script.
    *
+   * Entries can also be accessed by index, first entry has index
+   * 1. Lua @tt nil value is returned when reading above list
+   * size. Writing at list size + 1 appends an entry and writing a
+   * @tt nil value removes the entry. Lua operator @tt # returns the
+   * container entry count.
+   *
+   * The proxy keeps a cursor on the last accessed entry so that
+   * sequential access in either direction does not walk the list from
+   * its start. The cursor is reset when the list is modified through
+   * the proxy. The @ref reset_cursor function must be called when the
+   * list is modified directly from C++ code.
+   *
+   * The @tt{proxy:to_table()} lua method returns a table copy of the
+   * list and the @tt{proxy:from_table(table)} method replaces list
+   * content with entries of the table.
+   *
    * Containers may be attached and detached from the wrapper object
    * to solve cases where we want to destroy the container when lua
    * still holds references to the wrapper object. When no container
@@ -56,11 +73,41 @@ public:
 	/** Attach or detach container. argument may be NULL */
 	void set_container(Container *list);
 
+	/** Forget cached position in list. */
+	inline void reset_cursor();
+
+	Value meta_index(State *ls, const Value &key);
+	void meta_newindex(State *ls, const Value &key, const Value &value);
+	bool meta_contains(State *ls, const Value &key);
+	Value meta_operation(State *ls, Value::Operation op, const Value &a, const Value &b);
 	Ref<Iterator> new_iterator(State *ls);
 	bool support(Value::Operation c) const;
 
 private:
 	String get_type_name() const;
+	typename Container::iterator seek(int index);
+
+	/** Lua callable methods */
+	enum MethodId
+	{
+		MethodToTable,
+		MethodFromTable
+	};
+
+	/**
+   * @short QLinkedListProxy lua method class
+   * @internal
+   */
+	class ProxyMethod : public Function
+	{
+	public:
+		ProxyMethod(MethodId id);
+
+	private:
+		Value::List meta_call(State *ls, const Value::List &args);
+
+		MethodId _id;
+	};
 
 	/**
    * @short QLinkedListProxy iterator class
@@ -86,6 +133,8 @@ private:
 	};
 
 	Container *_linkedlist;
+	typename Container::iterator _cursor; //< iterator on last accessed entry
+	int _cursor_index; //< index of last accessed entry or -1
 };
 
 }
@@ -24,18 +24,21 @@
 #include "qtluaqlinkedlistproxy.hh"
 #include "qtluauserdata.hxx"
 #include "qtluaiterator.hxx"
+#include "qtluafunction.hxx"
 
 namespace QtLua {
 
 template <class Container>
 QLinkedListProxy<Container>::QLinkedListProxy()
 	: _linkedlist(0)
+	, _cursor_index(-1)
 {
 }
 
 template <class Container>
 QLinkedListProxy<Container>::QLinkedListProxy(Container &list)
 	: _linkedlist(&list)
+	, _cursor_index(-1)
 {
 }
 
@@ -43,6 +46,189 @@ template <class Container>
 void QLinkedListProxy<Container>::set_container(Container *list)
 {
 	_linkedlist = list;
+	reset_cursor();
+}
+
+template <class Container>
+void QLinkedListProxy<Container>::reset_cursor()
+{
+	_cursor_index = -1;
+}
+
+template <class Container>
+typename Container::iterator QLinkedListProxy<Container>::seek(int index)
+{
+	int size = _linkedlist->size();
+
+	// cursor points to the old storage if the list was shared
+	if (!_linkedlist->isDetached())
+	{
+		_linkedlist->detach();
+		_cursor_index = -1;
+	}
+
+	// start from the nearest known position
+	int from_cursor = _cursor_index < 0 ? size : qAbs(index - _cursor_index);
+
+	if (index <= from_cursor && index <= size - index)
+	{
+		_cursor = _linkedlist->begin();
+		_cursor_index = 0;
+	}
+	else if (size - index < from_cursor)
+	{
+		_cursor = _linkedlist->end();
+		_cursor_index = size;
+	}
+
+	while (_cursor_index < index)
+	{
+		++_cursor;
+		_cursor_index++;
+	}
+	while (_cursor_index > index)
+	{
+		--_cursor;
+		_cursor_index--;
+	}
+
+	return _cursor;
+}
+
+template <class Container>
+Value QLinkedListProxy<Container>::meta_index(State *ls, const Value &key)
+{
+	if (key.type() == Value::TString)
+	{
+		static ProxyMethod to_table_(MethodToTable);
+		static ProxyMethod from_table_(MethodFromTable);
+		String name(key.to_string());
+
+		if (name == "to_table")
+			return Value(ls, to_table_);
+		else if (name == "from_table")
+			return Value(ls, from_table_);
+		return Value(ls);
+	}
+
+	if (!_linkedlist)
+		return Value(ls);
+
+	int index = (unsigned int)key.to_number() - 1;
+
+	if (index >= 0 && index < _linkedlist->size())
+		return Value(ls, *seek(index));
+	else
+		return Value(ls);
+}
+
+template <class Container>
+void QLinkedListProxy<Container>::meta_newindex(State *ls, const Value &key, const Value &value)
+{
+	Q_UNUSED(ls)
+
+	if (!_linkedlist)
+		QTLUA_THROW(QtLua::QLinkedListProxy, "Can not index a null container.");
+
+	int index = (unsigned int)key.to_number() - 1;
+	int size = _linkedlist->size();
+
+	if (index < 0 || index > size)
+		QTLUA_THROW(QtLua::QLinkedListProxy, "Index % is out of bounds.", .arg(index + 1));
+
+	if (value.type() == Value::TNil)
+	{
+		if (index < size)
+		{
+			_linkedlist->erase(seek(index));
+			reset_cursor();
+		}
+	}
+	else
+	{
+		if (index == size)
+		{
+			_linkedlist->append(value);
+			reset_cursor();
+		}
+		else
+			*seek(index) = value;
+	}
+}
+
+template <class Container>
+bool QLinkedListProxy<Container>::meta_contains(State *ls, const Value &key)
+{
+	Q_UNUSED(ls)
+	try
+	{
+		int index = (unsigned int)key.to_number() - 1;
+
+		return _linkedlist && index >= 0 && index < _linkedlist->size();
+	}
+	catch (String &e)
+	{
+		return false;
+	}
+}
+
+template <class Container>
+Value QLinkedListProxy<Container>::meta_operation(State *ls, Value::Operation op, const Value &a, const Value &b)
+{
+	switch (op)
+	{
+	case Value::OpLen:
+		return Value(ls, _linkedlist ? _linkedlist->size() : 0);
+	default:
+		return UserData::meta_operation(ls, op, a, b);
+	}
+}
+
+template <class Container>
+QLinkedListProxy<Container>::ProxyMethod::ProxyMethod(MethodId id)
+	: _id(id)
+{
+}
+
+template <class Container>
+Value::List QLinkedListProxy<Container>::ProxyMethod::meta_call(State *ls, const Value::List &args)
+{
+	typename QLinkedListProxy::ptr self = get_arg_ud<QLinkedListProxy>(args, 0);
+	Container *list = self->_linkedlist;
+
+	if (!list)
+		QTLUA_THROW(QtLua::QLinkedListProxy, "Can not access a null container.");
+
+	switch (_id)
+	{
+	case MethodToTable:
+	{
+		Value::List values;
+		values.reserve(list->size());
+
+		for (typename Container::const_iterator i = list->constBegin(); i != list->constEnd(); ++i)
+			values.push_back(Value(ls, *i));
+
+		Value table(Value::new_table(ls, values.size()));
+		table.table_raw_set(1, values);
+		return table;
+	}
+
+	case MethodFromTable:
+	{
+		meta_call_check_args(args, 2, 2, Value::TUserData, Value::TTable);
+		const Value &table = args[1];
+		Value::List values = table.table_raw_get(1, table.len());
+
+		list->clear();
+		self->reset_cursor();
+		for (int i = 0; i < values.size(); i++)
+			list->append(values[i]);
+		break;
+	}
+	}
+
+	return Value::List();
 }
 
 template <class Container>
@@ -59,6 +245,9 @@ bool QLinkedListProxy<Container>::support(Value::Operation c) const
 {
 	switch (c)
 	{
+	case Value::OpIndex:
+	case Value::OpNewindex:
+	case Value::OpLen:
 	case Value::OpIterate:
 		return true;
 	default:
@@ -77,7 +266,7 @@ QLinkedListProxy<Container>::ProxyIterator::ProxyIterator(State *ls, const Ref<Q
 	: _ls(ls)
 	, _proxy(proxy)
 	, _it(_proxy->_linkedlist->begin())
-	, _i(0)
+	, _i(1)
 {
 }
 
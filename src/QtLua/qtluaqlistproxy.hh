@@ -25,6 +25,8 @@
 
 #include "qtluauserdata.hh"
 #include "qtluaiterator.hh"
+#include "qtluafunction.hh"
+#include "qtluaproxynotifier.hh"
 
 namespace QtLua {
 
@@ -37,6 +39,14 @@ namespace QtLua {
    * container object to lua script for read access. The @ref
    * QListProxy class may be used for read/write access.
    *
+   * The @tt{proxy:slice(i, j)} lua method returns a table copy of
+   * entries from index @tt i to index @tt j. Negative indexes are
+   * relative to the end of the list and both arguments are optional.
+   *
+   * Lua functions registered with the @tt{proxy:observe(func)}
+   * method are told about changes to the container, see @ref
+   * ProxyNotifier.
+   *
    * See @ref QListProxy class documentation for details and examples.
    */
 
@@ -51,9 +61,15 @@ public:
 	/** Create a @ref QListProxy object and attach given container */
 	QListProxyRo(Container &list);
 
+	~QListProxyRo();
+
 	/** Attach or detach container. argument may be NULL */
 	void set_container(Container *list);
 
+	/** Get change notifier of this proxy, created on first call. See
+      @ref ProxyNotifier for details. */
+	ProxyNotifier &notifier();
+
 	Value meta_index(State *ls, const Value &key);
 	bool meta_contains(State *ls, const Value &key);
 	Ref<Iterator> new_iterator(State *ls);
@@ -64,6 +80,29 @@ private:
 	void completion_patch(String &path, String &entry, int &offset);
 	String get_type_name() const;
 
+	/** Lua callable methods */
+	enum MethodId
+	{
+		MethodSlice,
+		MethodObserve,
+		MethodUnobserve
+	};
+
+	/**
+   * @short QListProxyRo lua method class
+   * @internal
+   */
+	class ProxyMethod : public Function
+	{
+	public:
+		ProxyMethod(MethodId id);
+
+	private:
+		Value::List meta_call(State *ls, const Value::List &args);
+
+		MethodId _id;
+	};
+
 	/**
    * @short QListProxyRo iterator class
    * @internal
@@ -88,7 +127,11 @@ private:
 	};
 
 protected:
+	/** Report change on given range of 1 based indexes if observed */
+	inline void notify(ProxyNotifier::ChangeType type, int first, int last);
+
 	Container *_list;
+	ProxyNotifier *_notifier;
 };
 
 /**
@@ -113,6 +156,17 @@ protected:
    * Lua operator @tt # returns the container entry count. Lua
    * operator @tt - returns a lua table copy of the container.
    *
+   * Ranges of entries can be transferred with a single call from lua
+   * using the following methods in addition to @tt{proxy:slice(i, j)}:
+   *
+   * @list
+   *   @item @tt{proxy:assign(i, table)} copies entries of the table
+   *     to the list starting at index @tt i, appending past the end.
+   *   @item @tt{proxy:append_table(table)} appends entries of the table.
+   *   @item @tt{proxy:resize(n)} truncates the list or appends default
+   *     constructed entries.
+   * @end list
+   *
    * The following example show how a @ref QList object can be
    * accessed from both C++ and lua script directly:
    *
@@ -132,8 +186,33 @@ public:
 	/** Create a @ref QListProxy object */
 	QListProxy(Container &list);
 
+	Value meta_index(State *ls, const Value &key);
 	void meta_newindex(State *ls, const Value &key, const Value &value);
 	bool support(enum Value::Operation c);
+
+private:
+	/** Lua callable methods */
+	enum MethodId
+	{
+		MethodAssign,
+		MethodAppendTable,
+		MethodResize
+	};
+
+	/**
+   * @short QListProxy lua method class
+   * @internal
+   */
+	class ProxyMethod : public Function
+	{
+	public:
+		ProxyMethod(MethodId id);
+
+	private:
+		Value::List meta_call(State *ls, const Value::List &args);
+
+		MethodId _id;
+	};
 };
 
 }
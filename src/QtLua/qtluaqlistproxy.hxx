@@ -24,21 +24,31 @@
 #include "qtluaqlistproxy.hh"
 #include "qtluauserdata.hxx"
 #include "qtluaiterator.hxx"
+#include "qtluafunction.hxx"
 
 namespace QtLua {
 
 template <class Container>
 QListProxyRo<Container>::QListProxyRo()
 	: _list(0)
+	, _notifier(0)
 {
 }
 
 template <class Container>
 QListProxyRo<Container>::QListProxyRo(Container &list)
 	: _list(&list)
+	, _notifier(0)
 {
 }
 
+template <class Container>
+QListProxyRo<Container>::~QListProxyRo()
+{
+	if (_notifier)
+		_notifier->destroy();
+}
+
 template <class Container>
 QListProxy<Container>::QListProxy()
 	: QListProxyRo<Container>()
@@ -57,9 +67,40 @@ void QListProxyRo<Container>::set_container(Container *list)
 	_list = list;
 }
 
+template <class Container>
+ProxyNotifier &QListProxyRo<Container>::notifier()
+{
+	if (!_notifier)
+		_notifier = new ProxyNotifier();
+	return *_notifier;
+}
+
+template <class Container>
+void QListProxyRo<Container>::notify(ProxyNotifier::ChangeType type, int first, int last)
+{
+	if (_notifier)
+		_notifier->notify_changed(first, last, type);
+}
+
 template <class Container>
 Value QListProxyRo<Container>::meta_index(State *ls, const Value &key)
 {
+	if (key.type() == Value::TString)
+	{
+		static ProxyMethod slice_(MethodSlice);
+		static ProxyMethod observe_(MethodObserve);
+		static ProxyMethod unobserve_(MethodUnobserve);
+		String name(key.to_string());
+
+		if (name == "slice")
+			return Value(ls, slice_);
+		else if (name == "observe")
+			return Value(ls, observe_);
+		else if (name == "unobserve")
+			return Value(ls, unobserve_);
+		return Value(ls);
+	}
+
 	if (!_list)
 		return Value(ls);
 
@@ -71,6 +112,159 @@ Value QListProxyRo<Container>::meta_index(State *ls, const Value &key)
 		return Value(ls);
 }
 
+template <class Container>
+Value QListProxy<Container>::meta_index(State *ls, const Value &key)
+{
+	if (key.type() == Value::TString)
+	{
+		static ProxyMethod assign_(MethodAssign);
+		static ProxyMethod append_table_(MethodAppendTable);
+		static ProxyMethod resize_(MethodResize);
+		String name(key.to_string());
+
+		if (name == "assign")
+			return Value(ls, assign_);
+		else if (name == "append_table")
+			return Value(ls, append_table_);
+		else if (name == "resize")
+			return Value(ls, resize_);
+	}
+
+	return QListProxyRo<Container>::meta_index(ls, key);
+}
+
+template <class Container>
+QListProxyRo<Container>::ProxyMethod::ProxyMethod(MethodId id)
+	: _id(id)
+{
+}
+
+template <class Container>
+Value::List QListProxyRo<Container>::ProxyMethod::meta_call(State *ls, const Value::List &args)
+{
+	typename QListProxyRo::ptr self = get_arg_ud<QListProxyRo>(args, 0);
+
+	switch (_id)
+	{
+	case MethodObserve:
+		meta_call_check_args(args, 2, 2, Value::TUserData, Value::TFunction);
+		self->notifier().add_observer(args[1]);
+		return Value::List();
+
+	case MethodUnobserve:
+		meta_call_check_args(args, 2, 2, Value::TUserData, Value::TFunction);
+		if (self->_notifier)
+			self->_notifier->remove_observer(args[1]);
+		return Value::List();
+
+	case MethodSlice:
+		break;
+	}
+
+	meta_call_check_args(args, 1, 3, Value::TUserData, Value::TNumber, Value::TNumber);
+	const Container *list = self->_list;
+
+	if (!list)
+		QTLUA_THROW(QtLua::QListProxy, "Can not slice a null container.");
+
+	int size = list->size();
+	int first = get_arg<int>(args, 1, 1);
+	int last = get_arg<int>(args, 2, size);
+
+	if (first < 0)
+		first += size + 1;
+	if (last < 0)
+		last += size + 1;
+	first = qMax(first, 1);
+	last = qMin(last, size);
+
+	int count = qMax(last - first + 1, 0);
+
+	// elements are pushed directly in the preallocated table
+	Value table(Value::new_table(ls, count));
+	table.table_raw_set(1, *list, first - 1, count);
+	return table;
+}
+
+template <class Container>
+QListProxy<Container>::ProxyMethod::ProxyMethod(MethodId id)
+	: _id(id)
+{
+}
+
+template <class Container>
+Value::List QListProxy<Container>::ProxyMethod::meta_call(State *ls, const Value::List &args)
+{
+	Q_UNUSED(ls)
+	typename QListProxy::ptr self = get_arg_ud<QListProxy>(args, 0);
+
+	if (!self->_list)
+		QTLUA_THROW(QtLua::QListProxy, "Can not index a null container.");
+
+	Container &list = *self->_list;
+	int first = 0, table_arg = 1;
+
+	switch (_id)
+	{
+	case MethodResize:
+	{
+		meta_call_check_args(args, 2, 2, Value::TUserData, Value::TNumber);
+		int size = get_arg<int>(args, 1);
+
+		int old_size = list.size();
+
+		if (size < 0)
+			QTLUA_THROW(QtLua::QListProxy, "Bad list size %.", .arg(size));
+		if (size < old_size)
+		{
+			list.erase(list.begin() + size, list.end());
+			self->notify(ProxyNotifier::ChangeRemove, size + 1, old_size);
+		}
+		while (list.size() < size)
+			list.append(typename Container::value_type());
+		if (size > old_size)
+			self->notify(ProxyNotifier::ChangeInsert, old_size + 1, size);
+		return Value::List();
+	}
+
+	case MethodAssign:
+		meta_call_check_args(args, 3, 3, Value::TUserData, Value::TNumber, Value::TTable);
+		first = get_arg<int>(args, 1) - 1;
+		table_arg = 2;
+		if (first < 0 || first > list.size())
+			QTLUA_THROW(QtLua::QListProxy, "Index % is out of bounds.", .arg(first + 1));
+		break;
+
+	case MethodAppendTable:
+		meta_call_check_args(args, 2, 2, Value::TUserData, Value::TTable);
+		first = list.size();
+		table_arg = 1;
+		break;
+	}
+
+	const Value &table = args[table_arg];
+	int count = table.len();
+	int size = list.size();
+
+	// convert all elements first, the list is left unchanged on error
+	QVector<typename Container::value_type> values(count);
+	table.table_raw_get(1, values, 0, count);
+
+	list.reserve(first + count);
+	for (int i = 0; i < count; i++)
+	{
+		if (first + i < size)
+			list[first + i] = values[i];
+		else
+			list.append(values[i]);
+	}
+
+	self->notify(ProxyNotifier::ChangeSet, first + 1, qMin(first + count, size));
+	self->notify(ProxyNotifier::ChangeInsert, size + 1, list.size());
+
+	return Value::List();
+}
+
 template <class Container>
 bool QListProxyRo<Container>::meta_contains(State *ls, const Value &key)
 {
@@ -162,14 +356,23 @@ void QListProxy<Container>::meta_newindex(State *ls, const Value &key, const Val
 	if (value.type() == Value::TNil)
 	{
 		if (index < (unsigned int)_list->size())
+		{
 			_list->removeAt(index);
+			this->notify(ProxyNotifier::ChangeRemove, index + 1, index + 1);
+		}
 	}
 	else
 	{
 		if (index == (unsigned int)_list->size())
+		{
 			_list->insert(index, value);
+			this->notify(ProxyNotifier::ChangeInsert, index + 1, index + 1);
+		}
 		else
+		{
 			(*_list)[index] = value;
+			this->notify(ProxyNotifier::ChangeSet, index + 1, index + 1);
+		}
 	}
 }
 
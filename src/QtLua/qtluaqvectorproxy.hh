@@ -25,6 +25,8 @@
 
 #include "qtluauserdata.hh"
 #include "qtluaiterator.hh"
+#include "qtluafunction.hh"
+#include "qtluaproxynotifier.hh"
 
 namespace QtLua {
 
@@ -40,6 +42,14 @@ namespace QtLua {
    * QVector may be resized if accessing above current size, depending
    * on @tt max_resize template parameter value. Resize above specified value is not allowed.
    *
+   * The @tt{proxy:slice(i, j)} lua method returns a table copy of
+   * entries from index @tt i to index @tt j. Negative indexes are
+   * relative to the end of the vector and both arguments are optional.
+   *
+   * Lua functions registered with the @tt{proxy:observe(func)}
+   * method are told about changes to the container, see @ref
+   * ProxyNotifier.
+   *
    * See @ref QVectorProxy class documentation for details and examples.
    */
 
@@ -56,9 +66,15 @@ public:
 	/** Create a @ref QVectorProxy object and attach given container */
 	QVectorProxyRo(Container &vector);
 
+	~QVectorProxyRo();
+
 	/** Attach or detach container. argument may be NULL */
 	void set_container(Container *vector);
 
+	/** Get change notifier of this proxy, created on first call. See
+      @ref ProxyNotifier for details. */
+	ProxyNotifier &notifier();
+
 	Value meta_operation(State *ls, Value::Operation op, const Value &a, const Value &b);
 	Value meta_index(State *ls, const Value &key);
 	bool meta_contains(State *ls, const Value &key);
@@ -69,6 +85,29 @@ private:
 	void completion_patch(String &path, String &entry, int &offset);
 	String get_type_name() const;
 
+	/** Lua callable methods */
+	enum MethodId
+	{
+		MethodSlice,
+		MethodObserve,
+		MethodUnobserve
+	};
+
+	/**
+   * @short QVectorProxyRo lua method class
+   * @internal
+   */
+	class ProxyMethod : public Function
+	{
+	public:
+		ProxyMethod(MethodId id);
+
+	private:
+		Value::List meta_call(State *ls, const Value::List &args);
+
+		MethodId _id;
+	};
+
 	/**
    * @short QVectorProxyRo iterator class
    * @internal
@@ -92,7 +131,11 @@ private:
 	};
 
 protected:
+	/** Report change on given range of 1 based indexes if observed */
+	inline void notify(ProxyNotifier::ChangeType type, int first, int last);
+
 	Container *_vector;
+	ProxyNotifier *_notifier;
 };
 
 /**
@@ -119,6 +162,19 @@ protected:
    * Lua operator @tt # returns the container entry count. Lua
    * operator @tt - returns a lua table copy of the container.
    *
+   * Ranges of entries can be transferred with a single call from lua
+   * using the following methods in addition to @tt{proxy:slice(i, j)}:
+   *
+   * @list
+   *   @item @tt{proxy:assign(i, table)} copies entries of the table
+   *     to the vector starting at index @tt i.
+   *   @item @tt{proxy:append_table(table)} appends entries of the table.
+   *   @item @tt{proxy:resize(n)} changes the vector size.
+   * @end list
+   *
+   * These methods are subject to the same size limits as index
+   * write access.
+   *
    * The following example show how a @ref QVector object can be
    * accessed from both C++ and lua script directly:
    *
@@ -140,8 +196,35 @@ public:
 	/** Create a @ref QVectorProxy object */
 	QVectorProxy(Container &vector);
 
+	Value meta_index(State *ls, const Value &key);
 	void meta_newindex(State *ls, const Value &key, const Value &value);
 	bool support(enum Value::Operation c);
+
+private:
+	void resize(int size);
+
+	/** Lua callable methods */
+	enum MethodId
+	{
+		MethodAssign,
+		MethodAppendTable,
+		MethodResize
+	};
+
+	/**
+   * @short QVectorProxy lua method class
+   * @internal
+   */
+	class ProxyMethod : public Function
+	{
+	public:
+		ProxyMethod(MethodId id);
+
+	private:
+		Value::List meta_call(State *ls, const Value::List &args);
+
+		MethodId _id;
+	};
 };
 
 }
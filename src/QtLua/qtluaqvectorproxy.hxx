@@ -24,21 +24,31 @@
 #include "qtluaqvectorproxy.hh"
 #include "qtluauserdata.hxx"
 #include "qtluaiterator.hxx"
+#include "qtluafunction.hxx"
 
 namespace QtLua {
 
 template <class Container, unsigned max_resize, unsigned min_resize>
 QVectorProxyRo<Container, max_resize, min_resize>::QVectorProxyRo()
 	: _vector(0)
+	, _notifier(0)
 {
 }
 
 template <class Container, unsigned max_resize, unsigned min_resize>
 QVectorProxyRo<Container, max_resize, min_resize>::QVectorProxyRo(Container &vector)
 	: _vector(&vector)
+	, _notifier(0)
 {
 }
 
+template <class Container, unsigned max_resize, unsigned min_resize>
+QVectorProxyRo<Container, max_resize, min_resize>::~QVectorProxyRo()
+{
+	if (_notifier)
+		_notifier->destroy();
+}
+
 template <class Container, unsigned max_resize, unsigned min_resize>
 QVectorProxy<Container, max_resize, min_resize>::QVectorProxy()
 	: QVectorProxyRo<Container, max_resize, min_resize>()
@@ -57,9 +67,40 @@ void QVectorProxyRo<Container, max_resize, min_resize>::set_container(Container
 	_vector = vector;
 }
 
+template <class Container, unsigned max_resize, unsigned min_resize>
+ProxyNotifier &QVectorProxyRo<Container, max_resize, min_resize>::notifier()
+{
+	if (!_notifier)
+		_notifier = new ProxyNotifier();
+	return *_notifier;
+}
+
+template <class Container, unsigned max_resize, unsigned min_resize>
+void QVectorProxyRo<Container, max_resize, min_resize>::notify(ProxyNotifier::ChangeType type, int first, int last)
+{
+	if (_notifier)
+		_notifier->notify_changed(first, last, type);
+}
+
 template <class Container, unsigned max_resize, unsigned min_resize>
 Value QVectorProxyRo<Container, max_resize, min_resize>::meta_index(State *ls, const Value &key)
 {
+	if (key.type() == Value::TString)
+	{
+		static ProxyMethod slice_(MethodSlice);
+		static ProxyMethod observe_(MethodObserve);
+		static ProxyMethod unobserve_(MethodUnobserve);
+		String name(key.to_string());
+
+		if (name == "slice")
+			return Value(ls, slice_);
+		else if (name == "observe")
+			return Value(ls, observe_);
+		else if (name == "unobserve")
+			return Value(ls, unobserve_);
+		return Value(ls);
+	}
+
 	if (!_vector)
 		return Value(ls);
 
@@ -71,6 +112,159 @@ Value QVectorProxyRo<Container, max_resize, min_resize>::meta_index(State *ls, c
 		return Value(ls);
 }
 
+template <class Container, unsigned max_resize, unsigned min_resize>
+Value QVectorProxy<Container, max_resize, min_resize>::meta_index(State *ls, const Value &key)
+{
+	if (key.type() == Value::TString)
+	{
+		static ProxyMethod assign_(MethodAssign);
+		static ProxyMethod append_table_(MethodAppendTable);
+		static ProxyMethod resize_(MethodResize);
+		String name(key.to_string());
+
+		if (name == "assign")
+			return Value(ls, assign_);
+		else if (name == "append_table")
+			return Value(ls, append_table_);
+		else if (name == "resize")
+			return Value(ls, resize_);
+	}
+
+	return QVectorProxyRo<Container, max_resize, min_resize>::meta_index(ls, key);
+}
+
+template <class Container, unsigned max_resize, unsigned min_resize>
+QVectorProxyRo<Container, max_resize, min_resize>::ProxyMethod::ProxyMethod(MethodId id)
+	: _id(id)
+{
+}
+
+template <class Container, unsigned max_resize, unsigned min_resize>
+Value::List QVectorProxyRo<Container, max_resize, min_resize>::ProxyMethod::meta_call(State *ls, const Value::List &args)
+{
+	typename QVectorProxyRo::ptr self = get_arg_ud<QVectorProxyRo>(args, 0);
+
+	switch (_id)
+	{
+	case MethodObserve:
+		meta_call_check_args(args, 2, 2, Value::TUserData, Value::TFunction);
+		self->notifier().add_observer(args[1]);
+		return Value::List();
+
+	case MethodUnobserve:
+		meta_call_check_args(args, 2, 2, Value::TUserData, Value::TFunction);
+		if (self->_notifier)
+			self->_notifier->remove_observer(args[1]);
+		return Value::List();
+
+	case MethodSlice:
+		break;
+	}
+
+	meta_call_check_args(args, 1, 3, Value::TUserData, Value::TNumber, Value::TNumber);
+	const Container *vector = self->_vector;
+
+	if (!vector)
+		QTLUA_THROW(QtLua::QVectorProxy, "Can not slice a null vector.");
+
+	int size = vector->size();
+	int first = get_arg<int>(args, 1, 1);
+	int last = get_arg<int>(args, 2, size);
+
+	if (first < 0)
+		first += size + 1;
+	if (last < 0)
+		last += size + 1;
+	first = qMax(first, 1);
+	last = qMin(last, size);
+
+	int count = qMax(last - first + 1, 0);
+
+	// elements are pushed directly in the preallocated table
+	Value table(Value::new_table(ls, count));
+	table.table_raw_set(1, *vector, first - 1, count);
+	return table;
+}
+
+template <class Container, unsigned max_resize, unsigned min_resize>
+QVectorProxy<Container, max_resize, min_resize>::ProxyMethod::ProxyMethod(MethodId id)
+	: _id(id)
+{
+}
+
+template <class Container, unsigned max_resize, unsigned min_resize>
+Value::List QVectorProxy<Container, max_resize, min_resize>::ProxyMethod::meta_call(State *ls, const Value::List &args)
+{
+	Q_UNUSED(ls)
+	typename QVectorProxy::ptr self = get_arg_ud<QVectorProxy>(args, 0);
+
+	if (!self->_vector)
+		QTLUA_THROW(QtLua::QVectorProxy, "Can not write to a null vector.");
+
+	Container &vector = *self->_vector;
+	int first = 0, table_arg = 1;
+
+	switch (_id)
+	{
+	case MethodResize:
+		meta_call_check_args(args, 2, 2, Value::TUserData, Value::TNumber);
+		self->resize(get_arg<int>(args, 1));
+		return Value::List();
+
+	case MethodAssign:
+		meta_call_check_args(args, 3, 3, Value::TUserData, Value::TNumber, Value::TTable);
+		first = get_arg<int>(args, 1) - 1;
+		table_arg = 2;
+		if (first < 0)
+			QTLUA_THROW(QtLua::QVectorProxy, "Index '%' is out of bounds.", .arg(first + 1));
+		break;
+
+	case MethodAppendTable:
+		meta_call_check_args(args, 2, 2, Value::TUserData, Value::TTable);
+		first = vector.size();
+		table_arg = 1;
+		break;
+	}
+
+	const Value &table = args[table_arg];
+	int count = table.len();
+	int size = vector.size();
+
+	// convert all elements first, the vector is left unchanged on error
+	QVector<typename Container::value_type> values(count);
+	table.table_raw_get(1, values, 0, count);
+
+	if (first + count > size)
+		self->resize(first + count);
+
+	for (int i = 0; i < count; i++)
+		vector[first + i] = values[i];
+
+	// entries past the previous size are reported as inserted by resize
+	self->notify(ProxyNotifier::ChangeSet, first + 1, qMin(first + count, size));
+
+	return Value::List();
+}
+
+template <class Container, unsigned max_resize, unsigned min_resize>
+void QVectorProxy<Container, max_resize, min_resize>::resize(int size)
+{
+	if (max_resize <= min_resize)
+		QTLUA_THROW(QtLua::QVectorProxy, "Can not resize this vector.");
+	if (size < (int)min_resize)
+		QTLUA_THROW(QtLua::QVectorProxy, "Can not reduce vector size below %.", .arg((int)min_resize));
+	if (size > (int)max_resize)
+		QTLUA_THROW(QtLua::QVectorProxy, "Can not increase vector size above %.", .arg((int)max_resize));
+
+	int old_size = _vector->size();
+	_vector->resize(size);
+
+	if (size > old_size)
+		this->notify(ProxyNotifier::ChangeInsert, old_size + 1, size);
+	else if (size < old_size)
+		this->notify(ProxyNotifier::ChangeRemove, size + 1, old_size);
+}
+
 template <class Container, unsigned max_resize, unsigned min_resize>
 bool QVectorProxyRo<Container, max_resize, min_resize>::meta_contains(State *ls, const Value &key)
 {
@@ -165,12 +359,19 @@ void QVectorProxy<Container, max_resize, min_resize>::meta_newindex(State *ls, c
 	{
 		if (index < min_resize)
 			QTLUA_THROW(QtLua::QVectorProxy, "Can not reduce vector size below %.", .arg((int)min_resize));
-		if (index < _vector->size())
+		int size = _vector->size();
+
+		if (index < size)
+		{
 			_vector->resize(index);
+			this->notify(ProxyNotifier::ChangeRemove, index + 1, size);
+		}
 	}
 	else
 	{
-		if (index >= _vector->size())
+		int size = _vector->size();
+
+		if (index >= size)
 		{
 			if (has_resize)
 			{
@@ -182,6 +383,11 @@ void QVectorProxy<Container, max_resize, min_resize>::meta_newindex(State *ls, c
 				goto oob;
 		}
 		(*_vector)[index] = value;
+
+		if (index < size)
+			this->notify(ProxyNotifier::ChangeSet, index + 1, index + 1);
+		else
+			this->notify(ProxyNotifier::ChangeInsert, size + 1, index + 1);
 	}
 
 	return;
@@ -0,0 +1,175 @@
+/*
+    This file is part of LibQtLua.
+
+    LibQtLua is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibQtLua is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LibQtLua.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright (C) 2008, Alexandre Becoulet <alexandre.becoulet@free.fr>
+
+*/
+
+#ifndef QTLUASCHEDULER_HH_
+#define QTLUASCHEDULER_HH_
+
+#include <QObject>
+#include <QPointer>
+#include <QHash>
+#include <QMap>
+#include <QQueue>
+#include <QTimer>
+#include <QElapsedTimer>
+
+#include "qtluavalue.hh"
+
+struct lua_State;
+
+namespace QtLua {
+
+class State;
+class SchedulerFunction;
+
+/**
+   * @short Event loop based lua coroutines scheduler
+   * @header QtLua/Scheduler
+   * @module {Base}
+   *
+   * This class runs lua tasks as coroutines driven by the Qt event
+   * loop. Ready tasks are resumed in round-robin order. The
+   * scheduler returns to the event loop once every ready task has
+   * been resumed or when the time slice has elapsed.
+   *
+   * The @tt spawn, @tt sleep, @tt wait, @tt yield, @tt kill and
+   * @tt stats lua functions are registered in the lua table specified
+   * on construction, the @tt sched table by default. The lua @tt wait
+   * function takes a @ref QObject and a signal signature; it suspends
+   * the current task until the Qt signal is emitted and returns the
+   * signal arguments. A lua error is raised in the task if the
+   * object is destroyed before the signal is emitted.
+   *
+   * Tasks which call a C++ function suspending the coroutine with
+   * @ref UserData::suspend are resumed by the scheduler once the
+   * associated @ref Pending object has been resumed.
+   *
+   * Lua errors raised by tasks are reported with the @ref task_error
+   * signal and the failing task is removed.
+   *
+   * @example examples/cpp/userdata/scheduler.cc:1
+   */
+class Scheduler : public QObject
+{
+	Q_OBJECT
+
+	friend class SchedulerFunction;
+
+public:
+	/** Scheduler statistics */
+	struct Stats
+	{
+		int tasks; //< number of live tasks
+		int ready; //< number of tasks ready to run
+		int sleeping; //< number of tasks suspended by @tt sleep
+		int waiting; //< number of tasks suspended by @tt wait or by a @ref Pending call
+		qint64 spawned; //< number of tasks created so far
+		qint64 finished; //< number of tasks which returned
+		qint64 errors; //< number of tasks terminated on error
+		qint64 resumes; //< number of task resumes
+	};
+
+	/** Create a scheduler for given @ref State object and register
+      its lua functions in the @tt path global table. */
+	Scheduler(State *ls, const String &path = "sched");
+	~Scheduler();
+
+	/** Create a new task running the given lua function. @return task id */
+	int spawn(const Value &function, const Value::List &args = Value::List());
+
+	/** Remove a task. @return false if no such task exists. */
+	bool kill(int id);
+
+	/** @This returns scheduler statistics. */
+	Stats get_stats() const;
+
+	/** Set maximum run duration in milliseconds before returning to
+      the event loop when tasks are ready. */
+	inline void set_time_slice(int ms);
+
+	/** @This returns time slice duration in milliseconds. */
+	inline int get_time_slice() const;
+
+signals:
+	/** This signal is emitted when a task is terminated by a lua error. */
+	void task_error(int id, const QString &error);
+
+private slots:
+	void run();
+	void wakeup_sleepers();
+	void wait_obj_destroyed(QObject *obj);
+
+private:
+	enum TaskState {
+		TaskReady,
+		TaskRunning,
+		TaskSleeping,
+		TaskWaiting,
+		TaskSuspended,
+	};
+
+	struct Task
+	{
+		int _id;
+		Value _thread;
+		lua_State *_lst;
+		TaskState _state;
+		Value::List _args; //< values returned to the task on resume
+		bool _error; //< raise _args as an error on resume
+		qint64 _deadline;
+		Value _waker; //< lua slot connected by wait
+		QPointer<QObject> _wait_obj;
+		QObject *_wait_key; //< waited object address, may be under destruction
+		String _wait_signal;
+	};
+
+	typedef QHash<int, Task *> task_hash_t;
+	typedef QMultiMap<qint64, Task *> sleep_map_t;
+
+	Task *current(State *ls) const;
+	void make_ready(Task *t);
+	void resume(Task *t);
+	void remove(Task *t);
+	void unwait(Task *t);
+	void sleep(Task *t, int ms);
+	void wait(Task *t, QObject *obj, const String &signal);
+	void wake(int id, const Value::List &args);
+	void resume_task(int id, const Value::List &args, bool error);
+	void schedule_sleepers();
+
+	QPointer<State> _ls;
+	task_hash_t _tasks;
+	QQueue<Task *> _ready;
+	sleep_map_t _sleepers;
+	Task *_current;
+	int _next_id;
+	int _time_slice;
+	QTimer _run_timer;
+	QTimer _sleep_timer;
+	QElapsedTimer _clock;
+
+	qint64 _spawned;
+	qint64 _finished;
+	qint64 _errors;
+	qint64 _resumes;
+};
+
+}
+
+#endif
@@ -24,6 +24,7 @@
 #include <QIODevice>
 #include <QObject>
 #include <QHash>
+#include <QPointer>
 
 #include "qtluastring.hh"
 #include "qtluavalue.hh"
@@ -34,6 +35,7 @@ struct lua_State;
 namespace QtLua {
 
 class Function;
+class Pending;
 
 /** @internal */
 typedef QObject *qobject_creator();
@@ -49,9 +51,6 @@ class UserData;
 class QObjectWrapper;
 class TableIterator;
 
-/** @internal */
-typedef QHash<QObject *, QObjectWrapper *> wrapper_hash_t;
-
 /** Specify lua standard libraries and QtLua lua libraries to load
       with the @ref State::openlib function. */
 enum Library {
@@ -99,6 +98,8 @@ class State : public QObject
 	friend class Value;
 	friend class ValueRef;
 	friend class TableIterator;
+	friend class Pending;
+	friend class Scheduler;
 	friend uint qHash(const Value &lv);
 
 public:
@@ -216,6 +217,14 @@ public:
 	template <class QObject_T>
 	static inline void register_qobject_meta_noconstruct();
 
+	/**
+   * @This builds QObject members wrappers for all classes exposed by
+   * the @tt{qt.meta} lua table. This is optional and may be called
+   * once at application startup so that scripts do not pay for it on
+   * first use of each class. This function is thread safe.
+   */
+	static void prebuild_meta_cache();
+
 	/**
    * @internal @This adds a new lua function.
    */
@@ -231,6 +240,31 @@ public:
    */
 	int lua_version() const;
 
+	/**
+   * @This sets the maximum number of lua threads kept for reuse by
+   * the @ref Value::new_thread function. Lua threads are put in the
+   * pool by the @ref recycle_thread function.
+   */
+	void set_thread_pool_size(int size);
+
+	/** @This returns the maximum number of pooled lua threads. */
+	inline int get_thread_pool_size() const;
+
+	/** @This returns the number of lua threads currently available in the pool. */
+	inline int get_thread_pool_count() const;
+
+	/**
+   * @This puts a lua thread value in the pool so that it can be
+   * reused by the @ref Value::new_thread function. Only coroutines
+   * which have returned without error are pooled. The thread value
+   * must not be resumed by the caller once recycled and must not be
+   * referenced from lua anymore, the next @ref Value::new_thread call
+   * would return the same lua thread.
+   *
+   * @return true if the thread has been added to the pool.
+   */
+	bool recycle_thread(const Value &thread);
+
 public slots:
 
 	/**
@@ -277,12 +311,22 @@ private:
 	static void lua_psettable(lua_State *st, int index);
 	static int lua_pnext(lua_State *st, int index);
 
+	// push a lua thread on stack, reuse a pooled thread if available
+	lua_State *new_thread(lua_State *st);
+	// put lua thread at top of stack in pool and pop it
+	bool recycle_thread(lua_State *st);
+
+	// resume a coroutine suspended by UserData::suspend
+	void resume_pending(const Value &thread, const Value::List &args, bool error);
+
 	// lua c functions
 	static int lua_cmd_iterator(lua_State *st);
 	static int lua_cmd_each(lua_State *st);
 	static int lua_cmd_print(lua_State *st);
 	static int lua_cmd_list(lua_State *st);
 	static int lua_cmd_qtype(lua_State *st);
+	static int lua_cmd_new_thread(lua_State *st);
+	static int lua_cmd_recycle_thread(lua_State *st);
 
 	// lua meta methods functions
 	static int lua_meta_item_add(lua_State *st);
@@ -305,13 +349,17 @@ private:
 	// static member addresses are used as lua registry table keys
 	static char _key_item_metatable;
 	static char _key_this;
+	static char _key_threads;
 
-	// QObjects wrappers are referenced here
-	wrapper_hash_t _whash;
+	// QObjects wrappers list, wrappers are found from their QObject
+	QObjectWrapper *_wrappers;
 
 	lua_State *_mst; //< main thread state
 	lua_State *_lst; //< current thread state
 	bool _yield_on_return;
+	QPointer<Pending> _last_pending; //< last suspended coroutine handle
+	int _thread_pool_size;
+	int _thread_pool_count;
 
 	QList<Function *> _functions;
 };
@@ -58,6 +58,16 @@ lua_State *State::get_lua_state() const
 	return _lst;
 }
 
+int State::get_thread_pool_size() const
+{
+	return _thread_pool_size;
+}
+
+int State::get_thread_pool_count() const
+{
+	return _thread_pool_count;
+}
+
 template <class QObject_T>
 static inline QObject *create_qobject()
 {
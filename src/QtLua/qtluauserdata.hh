@@ -36,6 +36,7 @@ class State;
 class Value;
 class UserData;
 class Iterator;
+class Pending;
 
 /**
  * @short Lua userdata objects base class
@@ -67,6 +68,7 @@ class UserData : public QtLua::Refobj<UserData>
 	friend class ValueBase;
 	friend class Value;
 	friend class ValueRef;
+	friend class QObjectWrapper;
 	friend uint qHash(const Value &lv);
 
 public:
@@ -216,6 +218,18 @@ protected:
    */
 	Value yield(State *ls) const;
 
+	/**
+   * When @this is invoked from the @ref meta_call function, QtLua
+   * will request lua to @em yield when the @ref meta_call function
+   * returns, like with the @ref yield function.
+   *
+   * The returned @ref Pending object must be used to resume the
+   * coroutine from the Qt event loop once the result of the
+   * asynchronous operation is available. An exception is thrown if
+   * not currently running inside a coroutine.
+   */
+	Pending *suspend(State *ls) const;
+
 	/**
    * This function may be reimplemented to further modify completion
    * result on console line when completed to a @ref UserData
@@ -22,6 +22,7 @@
 #define QTLUAUSEROBJECT_HH_
 
 #include <QPointer>
+#include <QHash>
 
 #include "qtluauserdata.hh"
 #include "qtluaiterator.hh"
@@ -84,6 +85,10 @@ private:
 
 	friend class UserObjectIterator;
 
+	/** @internal Property name to table index map */
+	typedef QHash<String, int> entry_index_t;
+
+	static entry_index_t build_entry_index();
 	int get_entry(const String &name);
 	T *_obj;
 
@@ -40,11 +40,34 @@ UserObject<T>::UserObject(T *obj)
 }
 
 template <class T>
-int UserObject<T>::get_entry(const String &name)
+typename UserObject<T>::entry_index_t UserObject<T>::build_entry_index()
 {
+	entry_index_t index;
+
+	// first entry wins when names are duplicated, as a linear search would
 	for (size_t i = 0; T::_qtlua_properties_table[i].name; i++)
-		if (name == T::_qtlua_properties_table[i].name)
-			return i;
+	{
+		String name(T::_qtlua_properties_table[i].name);
+
+		if (!index.contains(name))
+			index.insert(name, i);
+	}
+
+	return index;
+}
+
+template <class T>
+int UserObject<T>::get_entry(const String &name)
+{
+	// property name to table index hash, built once on first lookup,
+	// local static initialization is thread safe
+	static const entry_index_t index(build_entry_index());
+
+	typename entry_index_t::const_iterator i = index.constFind(name);
+
+	if (i != index.constEnd())
+		return i.value();
+
 	QTLUA_THROW(QtLua::UserObject, "No such property `%::%'.",
 				.arg(UserData::type_name<T>()).arg(name));
 }
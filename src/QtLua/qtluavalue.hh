@@ -50,6 +50,9 @@ class Value : public ValueBase
 	friend class TableIterator;
 	friend class ValueRef;
 	friend class ValueBase;
+	friend class Scheduler;
+	friend class QMetaValue;
+	friend class QObjectWrapper;
 
 public:
 	/** Create a lua value object with no associated @ref State */
@@ -113,7 +116,13 @@ public:
 	/** Create a new lua table value */
 	static inline Value new_table(const State *ls);
 
-	/** Create a new coroutine value with given entry point lua function. */
+	/** Create a new lua table value with room preallocated for
+      @tt array_size sequence entries and @tt hash_size other entries */
+	static inline Value new_table(const State *ls, int array_size, int hash_size = 0);
+
+	/** Create a new coroutine value with given entry point lua
+      function. A lua thread from the @ref State thread pool is used
+      if available. @see State::recycle_thread */
 	static inline Value new_thread(const State *ls, const Value &main);
 
 	/**
@@ -227,7 +236,7 @@ private:
 	Value(int index, const State *st);
 
 	void init_global();
-	void init_table();
+	void init_table(int array_size = 0, int hash_size = 0);
 	void init_thread(const Value &main);
 
 	double _id;
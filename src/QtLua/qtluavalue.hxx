@@ -194,6 +194,13 @@ Value Value::new_table(const State *ls)
 	return t;
 }
 
+Value Value::new_table(const State *ls, int array_size, int hash_size)
+{
+	Value t(ls);
+	t.init_table(array_size, hash_size);
+	return t;
+}
+
 Value Value::new_thread(const State *ls, const Value &main)
 {
 	Value t(ls);
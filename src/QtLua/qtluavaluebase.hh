@@ -23,6 +23,7 @@
 
 #include <QHash>
 #include <QList>
+#include <QVector>
 #include <QPointer>
 #include <QVariant>
 
@@ -154,6 +155,17 @@ public:
 		TThread = 8, //< Lua thread value
 	};
 
+	/**
+   * Specify how signal emissions are delivered to a connected lua value.
+   * @see connect
+   */
+	enum ConnectMode {
+		ConnectDirect, //< Call lua value on each signal emission
+		ConnectLatest, //< Call lua value once with arguments of the last emission
+		ConnectBatch, //< Call lua value once with a table of all emissions arguments
+		ConnectQueued, //< Call lua value for each emission from the event loop
+	};
+
 	/**
    * Specify lua operations performed on lua values.
    * @see UserData::meta_operation @see UserData::support
@@ -490,6 +502,30 @@ public:
 	void table_shift(int pos, int count, const Value &init, int len = -1);
 	inline void table_shift(int pos, int count, int len = -1);
 
+	/** Get @tt count consecutive entries of a lua table starting at
+      index @tt first. Metamethods are not invoked. */
+	List table_raw_get(int first, int count) const;
+
+	/** Set consecutive entries of a lua table starting at index @tt
+      first with values from list. Metamethods are not invoked. */
+	void table_raw_set(int first, const List &values) const;
+
+	/** Set @tt count consecutive entries of a lua table starting at
+      index @tt first with elements of a C++ list container starting
+      at index @tt pos. Numbers and strings are pushed directly on the
+      lua stack, other element types are converted through a @ref
+      Value object. Metamethods are not invoked. */
+	template <typename ListContainer>
+	void table_raw_set(int first, const ListContainer &list, int pos, int count) const;
+
+	/** Get @tt count consecutive entries of a lua table starting at
+      index @tt first into elements of a C++ list container starting
+      at index @tt pos, the container must be large enough. Numbers
+      and strings are read directly from the lua stack. Metamethods
+      are not invoked. */
+	template <typename ListContainer>
+	void table_raw_get(int first, ListContainer &list, int pos, int count) const;
+
 	/** Check given operation support. @see UserData::support */
 	bool support(Operation c) const;
 
@@ -519,12 +555,37 @@ public:
 	/**
    * Connect a @ref QObject signal to a lua value. The value will be
    * called when the signal is emited.
+   *
    * @see disconnect
    * @see QObject::connect
    * @xsee{QObject wrapping}
    */
 	bool connect(QObject *obj, const char *signal);
 
+	/**
+   * Connect a @ref QObject signal to a lua value using the specified
+   * delivery mode.
+   *
+   * When a coalescing @ref ConnectMode is used, emissions are
+   * recorded and the value is called later from the event loop,
+   * either on next iteration or when @tt interval milliseconds have
+   * elapsed since the first pending emission. In @ref ConnectBatch
+   * mode the value is called with the sender object and a table of
+   * arguments tables, one for each emission.
+   *
+   * Emissions from other threads are queued and delivered by the
+   * event loop of the @ref State thread, signal argument types must
+   * be registered for this to work. @ref ConnectQueued defers
+   * emissions from the @ref State thread to the next event loop turn
+   * as well. Emissions queued during a loop turn are delivered
+   * together, coalescing modes still apply to them.
+   *
+   * @see disconnect
+   * @see QObject::connect
+   * @xsee{QObject wrapping}
+   */
+	bool connect(QObject *obj, const char *signal, ConnectMode mode, int interval = 0);
+
 	/**
    * Disconnect a @ref QObject signal from a lua value.
    * @see connect
@@ -553,6 +614,40 @@ protected:
 	/** @internal */
 	static uint qHash(lua_State *st, int index);
 
+	/** @internal Push table value on lua stack, throw if not a table */
+	lua_State *raw_table_push() const;
+	/** @internal Pop table pushed by @ref raw_table_push */
+	static void raw_table_pop(lua_State *st);
+	/** @internal Push a new table with preallocated array entries on lua stack */
+	static void raw_table_new(lua_State *st, int array_size);
+	/** @internal Pop table on top of lua stack and set it as entry of the table below */
+	static void raw_table_seti(lua_State *st, int index);
+
+	/** @internal Set an entry of the table on top of lua stack. @multiple */
+	static void raw_seti(lua_State *st, int index, double n);
+	static void raw_seti(lua_State *st, int index, float n);
+	static void raw_seti(lua_State *st, int index, int n);
+	static void raw_seti(lua_State *st, int index, unsigned int n);
+	static void raw_seti(lua_State *st, int index, const String &str);
+	static void raw_seti(lua_State *st, int index, const QString &str);
+	static void raw_seti(lua_State *st, int index, const Value &v);
+	void raw_seti(lua_State *st, int index, const QVariant &v) const;
+	template <typename X>
+	inline void raw_seti(lua_State *st, int index, const QVector<X> &vector) const;
+	template <typename X>
+	inline void raw_seti(lua_State *st, int index, const X &x) const;
+
+	/** @internal Get an entry of the table on top of lua stack. @multiple */
+	void raw_geti(lua_State *st, int index, double &n) const;
+	void raw_geti(lua_State *st, int index, float &n) const;
+	void raw_geti(lua_State *st, int index, int &n) const;
+	void raw_geti(lua_State *st, int index, unsigned int &n) const;
+	void raw_geti(lua_State *st, int index, String &str) const;
+	void raw_geti(lua_State *st, int index, QString &str) const;
+	Value raw_geti(lua_State *st, int index) const;
+	template <typename X>
+	inline void raw_geti(lua_State *st, int index, X &x) const;
+
 	/** @internal */
 	void convert_error(ValueType type) const;
 	/** @internal */
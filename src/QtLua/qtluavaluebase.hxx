@@ -58,6 +58,76 @@ ListContainer ValueBase::to_list() const
 	return result;
 }
 
+template <typename ListContainer>
+void ValueBase::table_raw_set(int first, const ListContainer &list, int pos, int count) const
+{
+	lua_State *st = raw_table_push();
+
+	try
+	{
+		for (int i = 0; i < count; i++)
+			raw_seti(st, first + i, list.at(pos + i));
+	}
+	catch (...)
+	{
+		raw_table_pop(st);
+		throw;
+	}
+
+	raw_table_pop(st);
+}
+
+template <typename ListContainer>
+void ValueBase::table_raw_get(int first, ListContainer &list, int pos, int count) const
+{
+	lua_State *st = raw_table_push();
+
+	try
+	{
+		for (int i = 0; i < count; i++)
+			raw_geti(st, first + i, list[pos + i]);
+	}
+	catch (...)
+	{
+		raw_table_pop(st);
+		throw;
+	}
+
+	raw_table_pop(st);
+}
+
+template <typename X>
+void ValueBase::raw_seti(lua_State *st, int index, const QVector<X> &vector) const
+{
+	// nested table is filled on the lua stack as well
+	raw_table_new(st, vector.size());
+
+	try
+	{
+		for (int i = 0; i < vector.size(); i++)
+			raw_seti(st, i + 1, vector.at(i));
+	}
+	catch (...)
+	{
+		raw_table_pop(st);
+		throw;
+	}
+
+	raw_table_seti(st, index);
+}
+
+template <typename X>
+void ValueBase::raw_seti(lua_State *st, int index, const X &x) const
+{
+	raw_seti(st, index, Value(_st, x));
+}
+
+template <typename X>
+void ValueBase::raw_geti(lua_State *st, int index, X &x) const
+{
+	x = raw_geti(st, index);
+}
+
 ValueBase::operator Value() const
 {
 	return value();
@@ -23,6 +23,8 @@
 
 #include <QMap>
 #include <QHash>
+#include <QMutex>
+#include <QReadWriteLock>
 
 #include <QtLua/Ref>
 
@@ -36,7 +38,9 @@ class Member;
 class String;
 
 typedef QMap<String, Ref<Member> > member_cache_t;
-typedef QHash<const QMetaObject *, MetaCache> meta_cache_t;
+typedef QHash<String, Ref<Member> > member_hash_t;
+typedef QHash<const QMetaObject *, MetaCache *> meta_cache_t;
+typedef QHash<String, int> enum_hash_t;
 
 /**
  * @short Cache of existing Qt meta member wrappers
@@ -48,6 +52,9 @@ typedef QHash<const QMetaObject *, MetaCache> meta_cache_t;
  * @ref QMetaObject objects. These meta members are exposed to lua
  * through wrapper objects. This class manages a cache of already
  * created @ref Member based wrappers.
+ *
+ * Cache entries are built once for each class and never change nor
+ * move once published, they may be shared between threads.
  */
 
 class MetaCache
@@ -55,18 +62,20 @@ class MetaCache
 	friend class QObjectWrapper;
 
 	MetaCache(const QMetaObject *mo);
+	MetaCache(const MetaCache &mc);
 
 public:
-	/** Copy constructor */
-	inline MetaCache(const MetaCache &mc);
-
 	/** Get cache meta information for a QObject */
-	inline static MetaCache &get_meta(const QObject &obj);
+	inline static const MetaCache &get_meta(const QObject &obj);
 	/** Get cache meta information for a QMetaObject */
-	static MetaCache &get_meta(const QMetaObject *mo);
+	static const MetaCache &get_meta(const QMetaObject *mo);
+
+	/** Build cache entries of all classes known to the @tt qt lua
+	library, avoids building them on first use from scripts. */
+	static void prebuild();
 
-	/** Recursively search for memeber in class and parent classes */
-	Ref<Member> get_member(const String &name) const;
+	/** Search for memeber in class and parent classes */
+	inline Ref<Member> get_member(const String &name) const;
 	/** Recursively search for memeber in class and parent classes, throw if not found */
 	inline Ref<Member> get_member_throw(const String &name) const;
 	/** Recursively search for memeber in class and parent classes and
@@ -74,7 +83,9 @@ public:
 	template <class X>
 	typename X::ptr get_member_throw(const String &name) const;
 
-	/** Recursively search for enum value in class and parent classes, return -1 if not found */
+	/** Recursively search for enum value in class and parent classes,
+	return -1 if not found. Flags expressions like @tt{"A|B"} are
+	supported. */
 	int get_enum_value(const String &name) const;
 
 	/** Get member table */
@@ -84,9 +95,18 @@ public:
 	inline const QMetaObject *get_meta_object() const;
 
 private:
+	// members declared in this class
 	member_cache_t _member_cache;
+	// members visible from this class, including inherited members
+	member_hash_t _member_hash;
+	// enum keys visible from this class
+	enum_hash_t _enum_hash;
+	// valid flags expressions already evaluated
+	mutable enum_hash_t _flags_hash;
 	const QMetaObject *_mo;
 	static meta_cache_t _meta_cache;
+	static QReadWriteLock _meta_lock;
+	static QMutex _flags_lock;
 };
 
 }
@@ -27,10 +27,9 @@
 
 namespace QtLua {
 
-MetaCache::MetaCache(const MetaCache &mc)
-	: _member_cache(mc._member_cache)
-	, _mo(mc._mo)
+Member::ptr MetaCache::get_member(const String &name) const
 {
+	return _member_hash.value(name);
 }
 
 const member_cache_t &MetaCache::get_member_table() const
@@ -65,7 +64,7 @@ typename X::ptr MetaCache::get_member_throw(const String &name) const
 	return x;
 }
 
-MetaCache &MetaCache::get_meta(const QObject &obj)
+const MetaCache &MetaCache::get_meta(const QObject &obj)
 {
 	return get_meta(obj.metaObject());
 }
@@ -23,6 +23,7 @@
 
 #include <QMetaObject>
 #include <QMetaMethod>
+#include <QVector>
 
 #include <internal/qtluamember.hh>
 
@@ -39,6 +40,8 @@ namespace QtLua {
  */
 class Method : public Member
 {
+	friend class State;
+
 public:
 	QTLUA_REFTYPE(Method)
 
@@ -50,6 +53,31 @@ private:
 	String get_type_name() const;
 	String get_value_str() const;
 	void completion_patch(String &path, String &entry, int &offset);
+
+	/** @internal Qt method invocation descriptor */
+	struct CallDesc
+	{
+		int _index; //< absolute method index, -1 if no method for this arguments count
+		int _return_type; //< return value meta type, -1 if none
+		bool _callable; //< method is a slot or an invokable method
+		int _param_count;
+		int _param_types[10];
+	};
+
+	typedef QVector<CallDesc> call_desc_t;
+
+	/** Invoke method with arguments converted directly from lua
+	    stack, starting at @tt base. Return value is pushed on stack. */
+	int meta_call(State *ls, lua_State *st, const UserData::ptr &obj, int base);
+
+	QObject &get_call_object(const UserData::ptr &obj) const;
+	const CallDesc &get_call_desc(int lua_args_count) const;
+	void invoke(QObject &obj, const CallDesc &desc, void **qt_args) const;
+	void init_call_descs();
+
+	// descriptors indexed by lua arguments count, built on
+	// construction so that shared Method objects are never modified
+	call_desc_t _call_descs;
 };
 
 }
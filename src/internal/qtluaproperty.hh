@@ -57,6 +57,11 @@ private:
 
 	String get_value_str() const;
 	String get_type_name() const;
+
+	// meta type used to read/write property through qt_metacall,
+	// -1 if QVariant based access is required. Resolved on
+	// construction so that shared Property objects are never modified
+	int _storage_type;
 };
 
 }
@@ -46,12 +46,22 @@ public:
 	static Value raw_get_object(State *ls, int type, const void *data);
 	static void raw_set_object(int type, void *data, const Value &v);
 
+	/** Push Qt value directly on lua stack. @tt st must be the current
+	    lua thread of @tt ls. */
+	static void raw_push_object(State *ls, lua_State *st, int type, const void *data);
+	/** Convert lua stack value directly to Qt value. @tt st must be
+	    the current lua thread of @tt ls. */
+	static void raw_set_object(int type, void *data, State *ls, lua_State *st, int index);
+
 public:
 	inline void *get_data() const;
 
 	inline QMetaValue(int type, const Value &value);
 	inline QVariant to_qvariant() const;
 
+	inline QMetaValue(int type, State *ls, lua_State *st, int index);
+	inline void push_value(State *ls, lua_State *st) const;
+
 	inline QMetaValue(int type);
 	inline Value to_value(State *ls) const;
 
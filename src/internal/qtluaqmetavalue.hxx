@@ -59,6 +59,25 @@ QMetaValue::QMetaValue(int type, const Value &value)
 	}
 }
 
+QMetaValue::QMetaValue(int type, State *ls, lua_State *st, int index)
+{
+	init(type);
+	try
+	{
+		raw_set_object(_type, _data, ls, st, index);
+	}
+	catch (...)
+	{
+		QMetaType::destroy(_type, _data);
+		throw;
+	}
+}
+
+void QMetaValue::push_value(State *ls, lua_State *st) const
+{
+	raw_push_object(ls, st, _type, _data);
+}
+
 QVariant QMetaValue::to_qvariant() const
 {
 	return _type != QMetaType::Void ? QVariant(_type, _data) : QVariant();
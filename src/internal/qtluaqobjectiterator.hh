@@ -70,7 +70,7 @@ private:
 
 	QPointer<State> _ls;
 	Ref<QObjectWrapper> _qow;
-	MetaCache *_mc;
+	const MetaCache *_mc;
 	Current _cur;
 	member_cache_t::const_iterator _it;
 	int _child_id;
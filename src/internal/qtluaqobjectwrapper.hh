@@ -23,12 +23,17 @@
 
 #include <QObject>
 #include <QMetaObject>
+#include <QVector>
+#include <QVariant>
+#include <QHash>
+#include <QMutex>
 
 #include <QtLua/qtluauserdata.hh>
 
 namespace QtLua {
 
 class QObjectIterator;
+struct QObjectWrapperData;
 
 /**
  * @short QObject wrapper class
@@ -43,6 +48,8 @@ class QObjectIterator;
 class QObjectWrapper : public UserData, public QObject
 {
 	friend class QObjectIterator;
+	friend class State;
+	friend struct QObjectWrapperData;
 
 public:
 	QTLUA_REFTYPE(QObjectWrapper)
@@ -79,12 +86,16 @@ public:
 	/** Return object name, forge a decent one if empty */
 	static String qobject_name(QObject &obj);
 
+	/** Return name forged for objects with an empty name */
+	static QString qobject_default_name(const QObject &obj);
+
 	/** Find QObject child non-recursively */
 	static QObject *get_child(QObject &obj, const String &name);
 
 	// internal use only
 	int qt_metacall(QMetaObject::Call c, int id, void **args);
-	void _lua_connect(int sigindex, const Value &v);
+	void _lua_connect(int sigindex, const Value &v,
+					  Value::ConnectMode mode = Value::ConnectDirect, int interval = 0);
 	bool _lua_disconnect(int sigindex, const Value &v);
 	void _lua_disconnect_all(int sigindex);
 	void _lua_disconnect_all();
@@ -108,6 +119,12 @@ private:
 	void obj_destroyed();
 	void ref_single();
 
+	void attach();
+	void detach();
+
+	void customEvent(QEvent *event);
+	void timerEvent(QTimerEvent *event);
+
 private:
 	struct LuaSlot
 	{
@@ -115,14 +132,46 @@ private:
 
 		Value _value;
 		int _sigindex;
+		bool _function; //< slot value is a lua function
+		QVector<int> _param_types; //< signal parameters meta types
+		Value::ConnectMode _mode;
+		int _interval; //< coalescing delay in ms
+		int _timer_id; //< pending delivery timer, 0 if none
+		bool _scheduled; //< delivery of pending emissions is scheduled
+		QList<QList<QVariant> > _pending; //< raw arguments of pending emissions, converted on delivery
 	};
 
 	typedef QHash<int, LuaSlot> lua_slots_hash_t;
+	typedef QMultiHash<int, int> lua_slots_index_t;
+	typedef QMultiHash<Value, int> lua_slots_value_index_t;
+
+	/** @internal Signal emission deferred to the next event loop turn */
+	struct QueuedEmission
+	{
+		int _slot_id;
+		QList<QVariant> _args;
+	};
+
+	void lua_slot_enqueue(int slot_id, void **qt_args);
+	void lua_slot_dispatch(int slot_id, void **qt_args);
+	void lua_slot_remove(lua_slots_hash_t::iterator i);
+	void lua_slot_schedule(LuaSlot &slot);
+	void lua_slot_cancel(LuaSlot &slot);
+	void lua_slot_deliver(int slot_id);
 
 	State *_ls;
 	QObject *_obj;
+	QObjectWrapperData *_obj_data; //< wrappers of the QObject, 0 if detached
+	QObjectWrapper *_obj_next; //< next wrapper of the QObject for other State
+	QObjectWrapper *_ls_prev; //< State wrappers list
+	QObjectWrapper *_ls_next;
 	lua_slots_hash_t _lua_slots;
-	int _lua_next_slot;
+	lua_slots_index_t _lua_slots_by_signal; //< slot ids for each signal index
+	lua_slots_value_index_t _lua_slots_by_value; //< slot ids for each lua handler
+	int _lua_next_slot; //< slot ids are not reused, a stale call finds no slot
+	bool _flush_posted;
+	QMutex _queue_lock; //< guards _queue and _lua_slots updates against emitting threads
+	QList<QueuedEmission> _queue; //< emissions deferred to the next event loop turn
 	bool _reparent;
 	bool _delete;
 };
@@ -57,6 +57,11 @@ State *QObjectWrapper::get_state()
 QObjectWrapper::LuaSlot::LuaSlot(const Value &v, int sigindex)
 	: _value(v)
 	, _sigindex(sigindex)
+	, _function(false)
+	, _mode(Value::ConnectDirect)
+	, _interval(0)
+	, _timer_id(0)
+	, _scheduled(false)
 {
 }
 
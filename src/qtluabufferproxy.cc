@@ -0,0 +1,330 @@
+/*
+    This file is part of LibQtLua.
+
+    LibQtLua is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibQtLua is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LibQtLua.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright (C) 2008, Alexandre Becoulet <alexandre.becoulet@free.fr>
+
+*/
+
+#include <cstring>
+#include <limits>
+
+#include <QtEndian>
+
+#include <QtLua/BufferProxy>
+#include <QtLua/Function>
+
+namespace QtLua {
+
+BufferProxy::BufferProxy()
+	: _ptr(0)
+	, _size(0)
+{
+}
+
+BufferProxy::BufferProxy(const QByteArray &data)
+	: _ptr(0)
+	, _size(0)
+{
+	set_data(data);
+}
+
+BufferProxy::~BufferProxy()
+{
+	release();
+}
+
+void BufferProxy::release()
+{
+	// closing the file unmaps it
+	if (_file.isOpen())
+		_file.close();
+
+	_data.clear();
+	_ptr = 0;
+	_size = 0;
+}
+
+void BufferProxy::set_data(const QByteArray &data)
+{
+	release();
+
+	_data = data;
+	_ptr = reinterpret_cast<const uchar *>(_data.constData());
+	_size = _data.size();
+}
+
+bool BufferProxy::map_file(const QString &filename)
+{
+	release();
+
+	_file.setFileName(filename);
+	if (!_file.open(QIODevice::ReadOnly))
+		return false;
+
+	qint64 size = _file.size();
+
+	if (size > std::numeric_limits<int>::max())
+	{
+		_file.close();
+		return false;
+	}
+
+	if (size == 0)
+		return true;
+
+	uchar *map = _file.map(0, size);
+
+	if (!map)
+	{
+		_file.close();
+		return false;
+	}
+
+	_ptr = map;
+	_size = (int)size;
+	return true;
+}
+
+const uchar *BufferProxy::get_ptr(int offset, int size) const
+{
+	if (offset < 0 || size > _size - offset)
+		QTLUA_THROW(QtLua::BufferProxy, "Can not read % bytes at offset %.", .arg(size).arg(offset + 1));
+
+	return _ptr + offset;
+}
+
+Value BufferProxy::meta_index(State *ls, const Value &key)
+{
+	if (key.type() == Value::TString)
+		return get_method(ls, key.to_string());
+
+	int index = (unsigned int)key.to_number() - 1;
+
+	if (index >= 0 && index < _size)
+		return Value(ls, (int)_ptr[index]);
+	else
+		return Value(ls);
+}
+
+bool BufferProxy::meta_contains(State *ls, const Value &key)
+{
+	Q_UNUSED(ls)
+	try
+	{
+		int index = (unsigned int)key.to_number() - 1;
+
+		return index >= 0 && index < _size;
+	}
+	catch (String &e)
+	{
+		return false;
+	}
+}
+
+Value BufferProxy::meta_operation(State *ls, Value::Operation op, const Value &a, const Value &b)
+{
+	switch (op)
+	{
+	case Value::OpLen:
+		return Value(ls, _size);
+	default:
+		return UserData::meta_operation(ls, op, a, b);
+	}
+}
+
+bool BufferProxy::support(Value::Operation c) const
+{
+	switch (c)
+	{
+	case Value::OpIndex:
+	case Value::OpLen:
+		return true;
+	default:
+		return false;
+	}
+}
+
+Value BufferProxy::get_method(State *ls, const String &name)
+{
+	static BufferMethod sub_(MethodSub);
+	static BufferMethod find_(MethodFind);
+	static BufferMethod u8_(MethodU8);
+	static BufferMethod i8_(MethodI8);
+	static BufferMethod u16le_(MethodU16le);
+	static BufferMethod u16be_(MethodU16be);
+	static BufferMethod i16le_(MethodI16le);
+	static BufferMethod i16be_(MethodI16be);
+	static BufferMethod u32le_(MethodU32le);
+	static BufferMethod u32be_(MethodU32be);
+	static BufferMethod i32le_(MethodI32le);
+	static BufferMethod i32be_(MethodI32be);
+	static BufferMethod f32le_(MethodF32le);
+	static BufferMethod f32be_(MethodF32be);
+	static BufferMethod f64le_(MethodF64le);
+	static BufferMethod f64be_(MethodF64be);
+
+	if (name == "sub")
+		return Value(ls, sub_);
+	else if (name == "find")
+		return Value(ls, find_);
+	else if (name == "u8")
+		return Value(ls, u8_);
+	else if (name == "i8")
+		return Value(ls, i8_);
+	else if (name == "u16le")
+		return Value(ls, u16le_);
+	else if (name == "u16be")
+		return Value(ls, u16be_);
+	else if (name == "i16le")
+		return Value(ls, i16le_);
+	else if (name == "i16be")
+		return Value(ls, i16be_);
+	else if (name == "u32le")
+		return Value(ls, u32le_);
+	else if (name == "u32be")
+		return Value(ls, u32be_);
+	else if (name == "i32le")
+		return Value(ls, i32le_);
+	else if (name == "i32be")
+		return Value(ls, i32be_);
+	else if (name == "f32" || name == "f32le")
+		return Value(ls, f32le_);
+	else if (name == "f32be")
+		return Value(ls, f32be_);
+	else if (name == "f64" || name == "f64le")
+		return Value(ls, f64le_);
+	else if (name == "f64be")
+		return Value(ls, f64be_);
+
+	return Value(ls);
+}
+
+BufferProxy::BufferMethod::BufferMethod(MethodId id)
+	: _id(id)
+{
+}
+
+Value::List BufferProxy::BufferMethod::meta_call(State *ls, const Value::List &args)
+{
+	BufferProxy::ptr self = get_arg_ud<BufferProxy>(args, 0);
+	int size = self->_size;
+
+	switch (_id)
+	{
+	case MethodSub:
+	{
+		meta_call_check_args(args, 1, 3, Value::TUserData, Value::TNumber, Value::TNumber);
+		int first = get_arg<int>(args, 1, 1);
+		int last = get_arg<int>(args, 2, -1);
+
+		if (first < 0)
+			first += size + 1;
+		if (last < 0)
+			last += size + 1;
+		first = qMax(first, 1);
+		last = qMin(last, size);
+
+		if (first > last)
+			return Value(ls, String(""));
+
+		// wrap without copy, the only copy is done when pushing the lua string
+		return Value(ls, String(QByteArray::fromRawData(
+			reinterpret_cast<const char *>(self->_ptr) + first - 1, last - first + 1)));
+	}
+
+	case MethodFind:
+	{
+		meta_call_check_args(args, 2, 3, Value::TUserData, Value::TString, Value::TNumber);
+		String needle = get_arg<String>(args, 1);
+		int init = get_arg<int>(args, 2, 1);
+
+		if (init < 0)
+			init += size + 1;
+		init = qMax(init, 1);
+
+		if (init > size + 1)
+			return Value(ls);
+
+		QByteArray haystack(QByteArray::fromRawData(reinterpret_cast<const char *>(self->_ptr), size));
+		int i = haystack.indexOf(needle, init - 1);
+
+		if (i < 0)
+			return Value(ls);
+
+		return Value::List(Value(ls, i + 1), Value(ls, i + needle.size()));
+	}
+
+	default:
+		break;
+	}
+
+	meta_call_check_args(args, 2, 2, Value::TUserData, Value::TNumber);
+	int offset = get_arg<int>(args, 1) - 1;
+
+	switch (_id)
+	{
+	case MethodU8:
+		return Value(ls, (int)*self->get_ptr(offset, 1));
+	case MethodI8:
+		return Value(ls, (int)(qint8)*self->get_ptr(offset, 1));
+	case MethodU16le:
+		return Value(ls, (int)qFromLittleEndian<quint16>(self->get_ptr(offset, 2)));
+	case MethodU16be:
+		return Value(ls, (int)qFromBigEndian<quint16>(self->get_ptr(offset, 2)));
+	case MethodI16le:
+		return Value(ls, (int)qFromLittleEndian<qint16>(self->get_ptr(offset, 2)));
+	case MethodI16be:
+		return Value(ls, (int)qFromBigEndian<qint16>(self->get_ptr(offset, 2)));
+	case MethodU32le:
+		return Value(ls, (double)qFromLittleEndian<quint32>(self->get_ptr(offset, 4)));
+	case MethodU32be:
+		return Value(ls, (double)qFromBigEndian<quint32>(self->get_ptr(offset, 4)));
+	case MethodI32le:
+		return Value(ls, (int)qFromLittleEndian<qint32>(self->get_ptr(offset, 4)));
+	case MethodI32be:
+		return Value(ls, (int)qFromBigEndian<qint32>(self->get_ptr(offset, 4)));
+
+	case MethodF32le:
+	case MethodF32be:
+	{
+		const uchar *p = self->get_ptr(offset, 4);
+		quint32 bits = _id == MethodF32le ? qFromLittleEndian<quint32>(p) : qFromBigEndian<quint32>(p);
+		float f;
+
+		std::memcpy(&f, &bits, sizeof(f));
+		return Value(ls, (double)f);
+	}
+
+	case MethodF64le:
+	case MethodF64be:
+	{
+		const uchar *p = self->get_ptr(offset, 8);
+		quint64 bits = _id == MethodF64le ? qFromLittleEndian<quint64>(p) : qFromBigEndian<quint64>(p);
+		double d;
+
+		std::memcpy(&d, &bits, sizeof(d));
+		return Value(ls, d);
+	}
+
+	default:
+		break;
+	}
+
+	return Value::List();
+}
+
+}
+
@@ -23,6 +23,9 @@
 namespace QtLua {
 
 DispatchProxy::DispatchProxy()
+	: _routes_ready(false)
+	, _supported(0)
+	, _key_cache_enabled(false)
 {
 }
 
@@ -32,42 +35,110 @@ DispatchProxy::~DispatchProxy()
 		delete t;
 }
 
-Value DispatchProxy::meta_operation(State *ls, Value::Operation op, const Value &a, const Value &b)
+void DispatchProxy::set_key_cache(bool enabled)
+{
+	_key_cache_enabled = enabled;
+	_key_cache.clear();
+}
+
+void DispatchProxy::build_routes() const
 {
-	foreach (const TargetBase *t, _targets)
+	for (int i = 0; i < 16; i++)
+		_routes[i].clear();
+	_table_route.clear();
+	_supported = 0;
+
+	foreach (TargetBase *t, _targets)
 	{
-		if ((t->_ops & op) && t->_support(op))
-			return t->_meta_operation(ls, op, a, b);
+		t->_enabled = 0;
+
+		for (int i = 0; i < 16; i++)
+		{
+			Value::Operation op = (Value::Operation)(1 << i);
+
+			if ((t->_ops & op) && t->_support(op))
+			{
+				t->_enabled |= op;
+				_routes[i].push_back(t);
+			}
+		}
+
+		if (t->_enabled & (Value::OpIndex | Value::OpNewindex))
+			_table_route.push_back(t);
+
+		_supported |= t->_enabled;
 	}
 
+	_routes_ready = true;
+}
+
+const DispatchProxy::route_t &DispatchProxy::get_route(Value::Operation op) const
+{
+	if (!_routes_ready)
+		build_routes();
+
+	int i = 0;
+	while (i < 15 && !(op & (1 << i)))
+		i++;
+
+	return _routes[i];
+}
+
+Value DispatchProxy::meta_operation(State *ls, Value::Operation op, const Value &a, const Value &b)
+{
+	const route_t &route = get_route(op);
+
+	if (!route.isEmpty())
+		return route.first()->_meta_operation(ls, op, a, b);
+
 	return UserData::meta_operation(ls, op, a, b);
 }
 
 Value DispatchProxy::meta_index(State *ls, const Value &key)
 {
-	bool supported = false;
+	const route_t &route = get_route(Value::OpIndex);
+
+	if (route.isEmpty())
+		return UserData::meta_index(ls, key);
 
-	foreach (const TargetBase *t, _targets)
+	bool cache = _key_cache_enabled && key.type() == Value::TString;
+	String name;
+
+	if (cache)
 	{
-		if ((t->_ops & Value::OpIndex) && t->_support(Value::OpIndex))
-		{
-			supported = true;
+		name = key.to_string();
+		QHash<String, TargetBase *>::const_iterator i = _key_cache.find(name);
 
-			if (t->_meta_contains(ls, key))
-				return t->_meta_index(ls, key);
+		if (i != _key_cache.end() && i.value()->_meta_contains(ls, key))
+			return i.value()->_meta_index(ls, key);
+	}
+
+	foreach (const TargetBase *t, route)
+	{
+		if (t->_meta_contains(ls, key))
+		{
+			if (cache)
+				_key_cache.insert(name, const_cast<TargetBase *>(t));
+			return t->_meta_index(ls, key);
 		}
 	}
 
-	return supported ? Value(ls) : UserData::meta_index(ls, key);
+	return Value(ls);
 }
 
 void DispatchProxy::meta_newindex(State *ls, const Value &key, const Value &value)
 {
 	bool shadow = false;
 
-	foreach (const TargetBase *t, _targets)
+	if (!_routes_ready)
+		build_routes();
+
+	if (_key_cache_enabled && key.type() == Value::TString)
+		_key_cache.remove(key.to_string());
+
+	foreach (const TargetBase *t, _table_route)
 	{
-		if ((t->_ops & Value::OpNewindex) && t->_support(Value::OpNewindex))
+		if (t->_enabled & Value::OpNewindex)
 		{
 			bool c = t->_meta_contains(ls, key);
 
@@ -80,7 +151,7 @@ void DispatchProxy::meta_newindex(State *ls, const Value &key, const Value &valu
 				return t->_meta_newindex(ls, key, value);
 			}
 		}
-		else if ((t->_ops & Value::OpIndex) && t->_support(Value::OpIndex))
+		else
 		{
 			if (t->_meta_contains(ls, key))
 				shadow = true;
@@ -92,9 +163,12 @@ void DispatchProxy::meta_newindex(State *ls, const Value &key, const Value &valu
 
 bool DispatchProxy::meta_contains(State *ls, const Value &key)
 {
-	foreach (const TargetBase *t, _targets)
+	if (!_routes_ready)
+		build_routes();
+
+	foreach (const TargetBase *t, _table_route)
 	{
-		if ((t->_ops & (Value::OpIndex | Value::OpNewindex)) && (t->_support(Value::OpIndex) || t->_support(Value::OpNewindex)) && t->_meta_contains(ls, key))
+		if (t->_meta_contains(ls, key))
 			return true;
 	}
 
@@ -103,11 +177,10 @@ bool DispatchProxy::meta_contains(State *ls, const Value &key)
 
 Value::List DispatchProxy::meta_call(State *ls, const Value::List &args)
 {
-	foreach (const TargetBase *t, _targets)
-	{
-		if ((t->_ops & Value::OpCall) && t->_support(Value::OpCall))
-			return t->_meta_call(ls, args);
-	}
+	const route_t &route = get_route(Value::OpCall);
+
+	if (!route.isEmpty())
+		return route.first()->_meta_call(ls, args);
 
 	return UserData::meta_call(ls, args);
 }
@@ -119,28 +192,24 @@ Ref<Iterator> DispatchProxy::new_iterator(State *ls)
 
 bool DispatchProxy::support(enum Value::Operation c) const
 {
-	foreach (const TargetBase *t, _targets)
-	{
-		if ((t->_ops & c) && t->_support(c))
-			return true;
-	}
+	if (!_routes_ready)
+		build_routes();
 
-	return false;
+	return _supported & c;
 }
 
 bool DispatchProxy::ProxyIterator::_more()
 {
 	while (1)
 	{
+		const route_t &route = _dp.get_route(Value::OpIterate);
+
 		for (; !_cur.valid(); _index++)
 		{
-			if (_index == _dp._targets.size())
+			if (_index >= route.size())
 				return false;
 
-			if (!_dp._targets[_index]->_support(Value::OpIterate))
-				continue;
-
-			_cur = _dp._targets[_index]->_new_iterator(_state);
+			_cur = route[_index]->_new_iterator(_state);
 		}
 
 		if (_cur->more())
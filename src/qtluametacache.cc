@@ -18,38 +18,38 @@
 
 */
 
-#include <QSet>
 #include <QMetaMethod>
+#include <QSizePolicy>
 
 #include <internal/Method>
 #include <internal/Enum>
 #include <internal/Property>
 #include <internal/MetaCache>
+#include <internal/QMetaObjectWrapper>
 
 namespace QtLua {
 
 meta_cache_t MetaCache::_meta_cache;
+QReadWriteLock MetaCache::_meta_lock;
+QMutex MetaCache::_flags_lock;
 
 MetaCache::MetaCache(const QMetaObject *mo)
 	: _mo(mo)
 {
-	// Fill a set with existing member names in parent classes to
-	// detect names collisions
+	// Start with all members and enum keys visible from the parent
+	// class, names of new members are changed to avoid collisions
+	// with these
 
-	QSet<String> existing;
-
-	for (const QMetaObject *tmp = mo->superClass(); tmp; tmp = tmp->superClass())
+	if (const QMetaObject *super = mo->superClass())
 	{
-		const member_cache_t &mt = get_meta(tmp).get_member_table();
-
-		for (member_cache_t::const_iterator i = mt.begin(); i != mt.end(); i++)
-			existing.insert(i.key());
+		const MetaCache &mc = get_meta(super);
+		_member_hash = mc._member_hash;
+		_enum_hash = mc._enum_hash;
 	}
 
 	// Add method members
-	for (int i = 0; i < mo->methodCount(); i++)
+	for (int index = mo->methodOffset(); index < mo->methodCount(); index++)
 	{
-		int index = mo->methodOffset() + i;
 		QMetaMethod mm = mo->method(index);
 
 #if QT_VERSION < 0x050000
@@ -64,13 +64,17 @@ MetaCache::MetaCache(const QMetaObject *mo)
 
 		String name(signature.constData(), signature.indexOf('('));
 
-		while (existing.contains(name) || _member_cache.contains(name))
+		while (_member_hash.contains(name))
 			name += "_m";
 
-		_member_cache.insert(name, QTLUA_REFNEW(Method, mo, index));
+		Member::ptr m = QTLUA_REFNEW(Method, mo, index);
+		_member_cache.insert(name, m);
+		_member_hash.insert(name, m);
 	}
 
 	// Add enum members
+	enum_hash_t enum_keys;
+
 	for (int i = 0; i < mo->enumeratorCount(); i++)
 	{
 		int index = mo->enumeratorOffset() + i;
@@ -79,14 +83,33 @@ MetaCache::MetaCache(const QMetaObject *mo)
 		if (!me.isValid())
 			continue;
 
+		// first enum declaring a key wins within the class, keys are
+		// also available in the Class::Key scoped form
+		for (int j = 0; j < me.keyCount(); j++)
+		{
+			if (!enum_keys.contains(me.key(j)))
+				enum_keys.insert(me.key(j), me.value(j));
+
+			String scoped(QByteArray(me.scope()) + "::" + me.key(j));
+
+			if (!enum_keys.contains(scoped))
+				enum_keys.insert(scoped, me.value(j));
+		}
+
 		String name(me.name());
 
-		while (existing.contains(name) || _member_cache.contains(name))
+		while (_member_hash.contains(name))
 			name += "_e";
 
-		_member_cache.insert(name, QTLUA_REFNEW(Enum, mo, index));
+		Member::ptr m = QTLUA_REFNEW(Enum, mo, index);
+		_member_cache.insert(name, m);
+		_member_hash.insert(name, m);
 	}
 
+	// keys of enums declared in this class hide inherited ones
+	for (enum_hash_t::const_iterator i = enum_keys.constBegin(); i != enum_keys.constEnd(); ++i)
+		_enum_hash.insert(i.key(), i.value());
+
 	// Add property members
 	for (int i = 0; i < mo->propertyCount(); i++)
 	{
@@ -98,55 +121,84 @@ MetaCache::MetaCache(const QMetaObject *mo)
 
 		String name(mp.name());
 
-		while (existing.contains(name) || _member_cache.contains(name))
+		while (_member_hash.contains(name))
 			name += "_p";
 
-		_member_cache.insert(name, QTLUA_REFNEW(Property, mo, index));
+		Member::ptr m = QTLUA_REFNEW(Property, mo, index);
+		_member_cache.insert(name, m);
+		_member_hash.insert(name, m);
 	}
 }
 
-Member::ptr MetaCache::get_member(const String &name) const
+int MetaCache::get_enum_value(const String &name) const
 {
-	const MetaCache *mc = this;
-	Member::ptr m;
+	enum_hash_t::const_iterator i = _enum_hash.constFind(name);
+
+	if (i != _enum_hash.constEnd())
+		return i.value();
 
-	for (m = _member_cache.value(name);
-		 !m.valid() && mc->_mo->superClass();
-		 m = (mc = &MetaCache::get_meta(mc->_mo->superClass()))->get_member(name))
-		;
+	if (name.indexOf('|') < 0)
+		return -1;
+
+	QMutexLocker lock(&_flags_lock);
+
+	i = _flags_hash.constFind(name);
+
+	if (i != _flags_hash.constEnd())
+		return i.value();
 
-	return m;
+	// evaluate flags expression once
+	int value = 0;
+
+	foreach (const QByteArray &key, name.split('|'))
+	{
+		enum_hash_t::const_iterator k = _enum_hash.constFind(String(key.trimmed()));
+
+		// invalid expressions are not cached, their number is unbounded
+		if (k == _enum_hash.constEnd())
+			return -1;
+
+		value |= k.value();
+	}
+
+	_flags_hash.insert(name, value);
+	return value;
 }
 
-int MetaCache::get_enum_value(const String &name) const
+const MetaCache &MetaCache::get_meta(const QMetaObject *mo)
 {
-	for (const QMetaObject *mo = _mo; mo; mo = mo->superClass())
 	{
-		for (int i = 0; i < mo->enumeratorCount(); i++)
-		{
-			int index = mo->enumeratorOffset() + i;
-			QMetaEnum me = mo->enumerator(index);
+		QReadLocker lock(&_meta_lock);
+		meta_cache_t::const_iterator i = _meta_cache.constFind(mo);
 
-			if (!me.isValid())
-				continue;
+		if (i != _meta_cache.constEnd())
+			return *i.value();
+	}
 
-			int value = me.keyToValue(name);
-			if (value >= 0)
-				return value;
-		}
+	// build outside of the lock, parent class caches are built first
+	MetaCache *mc = new MetaCache(mo);
+
+	QWriteLocker lock(&_meta_lock);
+	meta_cache_t::const_iterator i = _meta_cache.constFind(mo);
+
+	if (i != _meta_cache.constEnd())
+	{
+		// an other thread was faster
+		delete mc;
+		return *i.value();
 	}
 
-	return -1;
+	_meta_cache.insert(mo, mc);
+	return *mc;
 }
 
-MetaCache &MetaCache::get_meta(const QMetaObject *mo)
+void MetaCache::prebuild()
 {
-	meta_cache_t::iterator i = _meta_cache.find(mo);
-
-	if (i != _meta_cache.end())
-		return i.value();
+	for (const meta_object_table_s *me = meta_object_table; me->_mo; me++)
+		get_meta(me->_mo);
 
-	return _meta_cache.insert(mo, MetaCache(mo)).value();
+	get_meta(&QObject::staticQtMetaObject);
+	get_meta(&QSizePolicy::staticMetaObject);
 }
 
 }
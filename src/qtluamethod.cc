@@ -26,19 +26,21 @@
 #include <internal/QMetaValue>
 #include <internal/qtluapoolarray.hh>
 
+extern "C" {
+#include <lua.h>
+}
+
 namespace QtLua {
 
 Method::Method(const QMetaObject *mo, int index)
 	: Member(mo, index)
 {
+	init_call_descs();
 }
 
-Value::List Method::meta_call(State *ls, const Value::List &lua_args)
+QObject &Method::get_call_object(const UserData::ptr &ud) const
 {
-	if (lua_args.size() < 1)
-		QTLUA_THROW(QtLua::Method, "Can't call method without object. (use ':' instead of '.')");
-
-	QObjectWrapper::ptr qow = lua_args[0].to_userdata_cast<QObjectWrapper>();
+	QObjectWrapper::ptr qow = ud.dynamiccast<QObjectWrapper>();
 
 	if (!qow.valid())
 		QTLUA_THROW(QtLua::Method, "The method first argument must be a QObject. (use ':' instead of '.')");
@@ -48,91 +50,167 @@ Value::List Method::meta_call(State *ls, const Value::List &lua_args)
 	if (!check_class(obj.metaObject()))
 		QTLUA_THROW(QtLua::Method, "The method doesn't belong to the class of the passed QObject.");
 
-	QMetaMethod mm = _mo->method(_index);
-	QList<QByteArray> pt = mm.parameterTypes();
-
-	int index_offset = 0;
-	int lua_args_count = lua_args.size() - 1;
-	bool lua_args_count_correct = (pt.size() == lua_args_count);
+	return obj;
+}
 
-	// if arguments count in Lua is less than C++ method arguments count,
-	// find method with the same name with correct arguments count.
-	if (lua_args_count < pt.size())
-	{
+const Method::CallDesc &Method::get_call_desc(int lua_args_count) const
+{
+	if (lua_args_count >= _call_descs.size() || _call_descs[lua_args_count]._index < 0)
+		QTLUA_THROW(QtLua::Method, "Wrong number of arguments for the '%' QMetaMethod.",
 #if QT_VERSION < 0x050000
-		QByteArray method_name_sig = mm.signature();
-		method_name_sig.truncate(method_name_sig.indexOf('(') + 1);
+					.arg(_mo->method(_index).signature()));
 #else
-		const QByteArray method_name = mm.name();
+					.arg(_mo->method(_index).methodSignature()));
 #endif
-		for (index_offset = 1;; ++index_offset)
-		{
-			mm = _mo->method(_index + index_offset);
+
+	const CallDesc &desc = _call_descs[lua_args_count];
+
+	if (desc._param_count > 10)
+		QTLUA_THROW(QtLua::Method, "The QMetaMethod '%' has too many arguments.",
 #if QT_VERSION < 0x050000
-			if (!QByteArray(mm.signature()).startsWith(method_name_sig))
+					.arg(_mo->method(desc._index).signature()));
 #else
-			if (mm.name() != method_name)
+					.arg(_mo->method(desc._index).methodSignature()));
 #endif
-				break;
-			pt = mm.parameterTypes();
-			if (pt.size() == lua_args_count)
-			{
-				lua_args_count_correct = true;
-				break;
-			}
-		}
-	}
 
-	if (!lua_args_count_correct)
-		QTLUA_THROW(QtLua::Method, "Wrong number of arguments for the '%' QMetaMethod.",
+	if (!desc._callable)
+		QTLUA_THROW(QtLua::Method, "The QMetaMethod '%' is not callable.",
 #if QT_VERSION < 0x050000
-					.arg(mm.signature()));
+					.arg(_mo->method(desc._index).signature()));
 #else
-					.arg(mm.methodSignature()));
+					.arg(_mo->method(desc._index).methodSignature()));
 #endif
 
-	if (mm.methodType() != QMetaMethod::Slot && mm.methodType() != QMetaMethod::Method)
-		QTLUA_THROW(QtLua::Method, "The QMetaMethod '%' is not callable.",
+	return desc;
+}
+
+void Method::invoke(QObject &obj, const CallDesc &desc, void **qt_args) const
+{
+	if (!obj.qt_metacall(QMetaObject::InvokeMetaMethod, desc._index, qt_args))
+		QTLUA_THROW(QtLua::Method, "Error on invocation of the '%' Qt method.",
 #if QT_VERSION < 0x050000
-					.arg(mm.signature()));
+					.arg(_mo->method(desc._index).signature()));
 #else
-					.arg(mm.methodSignature()));
+					.arg(_mo->method(desc._index).methodSignature()));
 #endif
+}
+
+Value::List Method::meta_call(State *ls, const Value::List &lua_args)
+{
+	if (lua_args.size() < 1)
+		QTLUA_THROW(QtLua::Method, "Can't call method without object. (use ':' instead of '.')");
+
+	QObject &obj = get_call_object(lua_args[0].to_userdata());
+	const CallDesc &desc = get_call_desc(lua_args.size() - 1);
 
 	PoolArray<QMetaValue, 11> args;
 	void *qt_args[11];
 
 	// return value
-	if (*mm.typeName())
-		qt_args[0] = args.create(QMetaType::type(mm.typeName())).get_data();
+	if (desc._return_type >= 0)
+		qt_args[0] = args.create(desc._return_type).get_data();
 	else
 		qt_args[0] = 0;
 
-	int i = 1;
-
 	// parameters
-	foreach (const QByteArray &pt, pt)
-	{
-		Q_ASSERT(i < 11);
+	for (int i = 0; i < desc._param_count; i++)
+		qt_args[i + 1] = args.create(desc._param_types[i], lua_args[i + 1]).get_data();
 
-		qt_args[i] = args.create(QMetaType::type(pt.constData()), lua_args[i]).get_data();
+	// actual invocation
+	invoke(obj, desc, qt_args);
 
-		i++;
-	}
+	if (qt_args[0])
+		return args[0].to_value(ls);
+	else
+		return Value::List();
+}
+
+int Method::meta_call(State *ls, lua_State *st, const UserData::ptr &ud, int base)
+{
+	int lua_args_count = lua_gettop(st) - base + 1;
+
+	if (lua_args_count < 0)
+		QTLUA_THROW(QtLua::Method, "Can't call method without object. (use ':' instead of '.')");
+
+	QObject &obj = get_call_object(ud);
+	const CallDesc &desc = get_call_desc(lua_args_count);
+
+	PoolArray<QMetaValue, 11> args;
+	void *qt_args[11];
+
+	// return value
+	if (desc._return_type >= 0)
+		qt_args[0] = args.create(desc._return_type).get_data();
+	else
+		qt_args[0] = 0;
+
+	// parameters
+	for (int i = 0; i < desc._param_count; i++)
+		qt_args[i + 1] = args.create(desc._param_types[i], ls, st, base + i).get_data();
 
 	// actual invocation
-	if (!obj.qt_metacall(QMetaObject::InvokeMetaMethod, _index + index_offset, qt_args))
-		QTLUA_THROW(QtLua::Method, "Error on invocation of the '%' Qt method.",
+	invoke(obj, desc, qt_args);
+
+	if (!qt_args[0])
+		return 0;
+
+	args[0].push_value(ls, st);
+	return 1;
+}
+
+void Method::init_call_descs()
+{
+	QMetaMethod mm = _mo->method(_index);
+	int count = mm.parameterTypes().size();
+	call_desc_t descs(count + 1);
+
+	for (int i = 0; i <= count; i++)
+		descs[i]._index = -1;
+
 #if QT_VERSION < 0x050000
-					.arg(mm.signature()));
+	QByteArray method_name_sig = mm.signature();
+	method_name_sig.truncate(method_name_sig.indexOf('(') + 1);
 #else
-					.arg(mm.methodSignature()));
+	const QByteArray method_name = mm.name();
 #endif
 
-	if (qt_args[0])
-		return args[0].to_value(ls);
-	else
-		return Value::List();
+	// methods with default arguments are followed by methods with
+	// the same name and less arguments
+	for (int index = _index; index < _mo->methodCount(); index++)
+	{
+		QMetaMethod m = _mo->method(index);
+
+		if (index > _index)
+		{
+#if QT_VERSION < 0x050000
+			if (!QByteArray(m.signature()).startsWith(method_name_sig))
+#else
+			if (m.name() != method_name)
+#endif
+				break;
+		}
+
+		QList<QByteArray> pt = m.parameterTypes();
+
+		if (pt.size() > count || descs[pt.size()]._index >= 0)
+			continue;
+
+		CallDesc &desc = descs[pt.size()];
+
+		desc._index = index;
+		desc._return_type = *m.typeName() ? QMetaType::type(m.typeName()) : -1;
+		desc._callable = m.methodType() == QMetaMethod::Slot || m.methodType() == QMetaMethod::Method;
+		desc._param_count = pt.size();
+
+		// reported as an error on call
+		if (pt.size() > 10)
+			continue;
+
+		for (int i = 0; i < pt.size(); i++)
+			desc._param_types[i] = QMetaType::type(pt[i].constData());
+	}
+
+	_call_descs = descs;
 }
 
 String Method::get_type_name() const
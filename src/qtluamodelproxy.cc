@@ -0,0 +1,351 @@
+/*
+    This file is part of LibQtLua.
+
+    LibQtLua is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibQtLua is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LibQtLua.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright (C) 2008, Alexandre Becoulet <alexandre.becoulet@free.fr>
+
+*/
+
+#include <QtLua/ModelProxy>
+#include <QtLua/Function>
+
+namespace QtLua {
+
+ModelProxy::ModelProxy(int role)
+	: _role(role)
+	, _cache_row(-1)
+{
+}
+
+ModelProxy::ModelProxy(QAbstractItemModel &model, int role)
+	: _role(role)
+	, _cache_row(-1)
+{
+	set_model(&model);
+}
+
+void ModelProxy::set_model(QAbstractItemModel *model)
+{
+	if (_model)
+		_model->disconnect(this);
+
+	_model = model;
+	_columns.clear();
+	_roles.clear();
+	_cache_row = -1;
+
+	if (!model)
+		return;
+
+	connect(model, SIGNAL(dataChanged(QModelIndex, QModelIndex)),
+			this, SLOT(data_changed(QModelIndex, QModelIndex)));
+	connect(model, SIGNAL(rowsInserted(QModelIndex, int, int)), this, SLOT(rows_changed()));
+	connect(model, SIGNAL(rowsRemoved(QModelIndex, int, int)), this, SLOT(rows_changed()));
+	connect(model, SIGNAL(rowsMoved(QModelIndex, int, int, QModelIndex, int)), this, SLOT(rows_changed()));
+	connect(model, SIGNAL(layoutChanged()), this, SLOT(rows_changed()));
+	connect(model, SIGNAL(columnsInserted(QModelIndex, int, int)), this, SLOT(header_changed()));
+	connect(model, SIGNAL(columnsRemoved(QModelIndex, int, int)), this, SLOT(header_changed()));
+	connect(model, SIGNAL(headerDataChanged(Qt::Orientation, int, int)), this, SLOT(header_changed()));
+	connect(model, SIGNAL(modelReset()), this, SLOT(header_changed()));
+}
+
+void ModelProxy::data_changed(const QModelIndex &top_left, const QModelIndex &bottom_right)
+{
+	if (!top_left.parent().isValid() &&
+		_cache_row >= top_left.row() && _cache_row <= bottom_right.row())
+		_cache_row = -1;
+}
+
+void ModelProxy::rows_changed()
+{
+	_cache_row = -1;
+}
+
+void ModelProxy::header_changed()
+{
+	_columns.clear();
+	_roles.clear();
+	_cache_row = -1;
+}
+
+bool ModelProxy::fetch_rows(int count)
+{
+	int rows = _model->rowCount();
+
+	while (rows < count && _model->canFetchMore(QModelIndex()))
+	{
+		_model->fetchMore(QModelIndex());
+
+		int more = _model->rowCount();
+		if (more == rows)
+			break;
+		rows = more;
+	}
+
+	return rows >= count;
+}
+
+int ModelProxy::get_column(const Value &key)
+{
+	if (key.type() != Value::TString)
+		return key.to_integer() - 1;
+
+	if (_columns.isEmpty())
+	{
+		int count = _model->columnCount();
+
+		for (int i = 0; i < count; i++)
+			_columns.insert(_model->headerData(i, Qt::Horizontal).toString(), i);
+	}
+
+	QHash<String, int>::const_iterator i = _columns.find(key.to_string());
+
+	if (i == _columns.end())
+		QTLUA_THROW(QtLua::ModelProxy, "No such column '%'.", .arg(key.to_string()));
+
+	return i.value();
+}
+
+int ModelProxy::get_role(const Value &key)
+{
+	switch (key.type())
+	{
+	case Value::TNone:
+	case Value::TNil:
+		return _role;
+
+	case Value::TString:
+		break;
+
+	default:
+		return key.to_integer();
+	}
+
+	if (_roles.isEmpty())
+	{
+		QHash<int, QByteArray> names = _model->roleNames();
+
+		for (QHash<int, QByteArray>::const_iterator i = names.begin(); i != names.end(); i++)
+			_roles.insert(String(i.value()), i.key());
+	}
+
+	QHash<String, int>::const_iterator i = _roles.find(key.to_string());
+
+	if (i == _roles.end())
+		QTLUA_THROW(QtLua::ModelProxy, "No such role '%'.", .arg(key.to_string()));
+
+	return i.value();
+}
+
+const QVariant &ModelProxy::get_cell(int row, int column)
+{
+	if (_cache_row != row)
+	{
+		int count = _model->columnCount();
+
+		_cache.resize(count);
+		for (int i = 0; i < count; i++)
+			_cache[i] = _model->data(_model->index(row, i), _role);
+		_cache_row = row;
+	}
+
+	static const QVariant none;
+
+	if (column < 0 || column >= _cache.size())
+		return none;
+
+	return _cache[column];
+}
+
+Value ModelProxy::meta_index(State *ls, const Value &key)
+{
+	if (key.type() == Value::TString)
+	{
+		static RowsMethod rows;
+
+		if (key.to_string() == "rows")
+			return Value(ls, rows);
+		return Value(ls);
+	}
+
+	if (!_model)
+		return Value(ls);
+
+	int row = key.to_integer() - 1;
+
+	if (row < 0 || !fetch_rows(row + 1))
+		return Value(ls);
+
+	return Value(ls, QTLUA_REFNEW(Row, *this, row));
+}
+
+bool ModelProxy::meta_contains(State *ls, const Value &key)
+{
+	Q_UNUSED(ls)
+	try
+	{
+		int row = key.to_integer() - 1;
+
+		return _model && row >= 0 && row < _model->rowCount();
+	}
+	catch (String &e)
+	{
+		return false;
+	}
+}
+
+Value ModelProxy::meta_operation(State *ls, Value::Operation op, const Value &a, const Value &b)
+{
+	switch (op)
+	{
+	case Value::OpLen:
+		return Value(ls, _model ? _model->rowCount() : 0);
+	default:
+		return UserData::meta_operation(ls, op, a, b);
+	}
+}
+
+bool ModelProxy::support(Value::Operation c) const
+{
+	switch (c)
+	{
+	case Value::OpIndex:
+	case Value::OpLen:
+		return true;
+	default:
+		return false;
+	}
+}
+
+ModelProxy::Row::Row(const Ref<ModelProxy> &proxy, int row)
+	: _proxy(proxy)
+	, _index(proxy->_model->index(row, 0))
+{
+}
+
+int ModelProxy::Row::get_row() const
+{
+	// row has been removed or proxy attached to an other model
+	if (!_index.isValid() || _index.model() != _proxy->_model.data())
+		return -1;
+
+	return _index.row();
+}
+
+Value ModelProxy::Row::meta_index(State *ls, const Value &key)
+{
+	int row = get_row();
+
+	if (row < 0)
+		return Value(ls);
+
+	return Value(ls, _proxy->get_cell(row, _proxy->get_column(key)));
+}
+
+void ModelProxy::Row::meta_newindex(State *ls, const Value &key, const Value &value)
+{
+	Q_UNUSED(ls)
+	QAbstractItemModel *model = _proxy->_model;
+
+	if (!model)
+		QTLUA_THROW(QtLua::ModelProxy, "Can not write to a null model.");
+
+	int row = get_row();
+
+	if (row < 0)
+		QTLUA_THROW(QtLua::ModelProxy, "The model row has been removed.");
+
+	QModelIndex index = model->index(row, _proxy->get_column(key));
+
+	if (!index.isValid() || !model->setData(index, value.to_qvariant(), _proxy->_role))
+		QTLUA_THROW(QtLua::ModelProxy, "Unable to set model data at row % column %.",
+					.arg(row + 1).arg(index.column() + 1));
+}
+
+Value ModelProxy::Row::meta_operation(State *ls, Value::Operation op, const Value &a, const Value &b)
+{
+	switch (op)
+	{
+	case Value::OpLen:
+		return Value(ls, _proxy->_model ? _proxy->_model->columnCount() : 0);
+	default:
+		return UserData::meta_operation(ls, op, a, b);
+	}
+}
+
+bool ModelProxy::Row::support(Value::Operation c) const
+{
+	switch (c)
+	{
+	case Value::OpIndex:
+	case Value::OpNewindex:
+	case Value::OpLen:
+		return true;
+	default:
+		return false;
+	}
+}
+
+Value::List ModelProxy::RowsMethod::meta_call(State *ls, const Value::List &args)
+{
+	meta_call_check_args(args, 1, 4, Value::TUserData, Value::TNumber, Value::TNone, Value::TNone);
+	ModelProxy::ptr self = get_arg_ud<ModelProxy>(args, 0);
+	QAbstractItemModel *model = self->_model;
+
+	if (!model)
+		QTLUA_THROW(QtLua::ModelProxy, "Can not read rows from a null model.");
+
+	int first = get_arg<int>(args, 1, 1) - 1;
+	int role = self->get_role(args.size() > 3 ? args[3] : Value(ls));
+
+	if (first < 0)
+		QTLUA_THROW(QtLua::ModelProxy, "Bad first row %.", .arg(first + 1));
+
+	int count;
+	// a nil count reads rows until the end of the model
+	if (args.size() > 2 && args[2].type() != Value::TNil)
+	{
+		if (args[2].type() != Value::TNumber)
+			QTLUA_THROW(QtLua::ModelProxy, "Bad row count type, `lua::number' expected instead of '%'.",
+						.arg(args[2].type_name()));
+
+		count = get_arg<int>(args, 2);
+		self->fetch_rows(first + count);
+		count = qMin(count, model->rowCount() - first);
+	}
+	else
+	{
+		count = model->rowCount() - first;
+	}
+
+	int columns = model->columnCount();
+	QVector<QVector<QVariant> > rows(qMax(count, 0));
+
+	for (int i = 0; i < rows.size(); i++)
+	{
+		QVector<QVariant> &cells = rows[i];
+		cells.resize(columns);
+
+		for (int j = 0; j < columns; j++)
+			cells[j] = model->data(model->index(first + i, j), role);
+	}
+
+	// row tables and cells are pushed directly in the preallocated table
+	Value table(Value::new_table(ls, rows.size()));
+	table.table_raw_set(1, rows, 0, rows.size());
+	return table;
+}
+
+}
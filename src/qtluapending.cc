@@ -0,0 +1,93 @@
+/*
+    This file is part of LibQtLua.
+
+    LibQtLua is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibQtLua is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LibQtLua.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright (C) 2008, Alexandre Becoulet <alexandre.becoulet@free.fr>
+
+*/
+
+#include <QDebug>
+
+#include <QtLua/Pending>
+#include <QtLua/State>
+#include <QtLua/Scheduler>
+
+namespace QtLua {
+
+Pending::Pending(State *ls, const Value &thread)
+	: QObject(ls)
+	, _ls(ls)
+	, _thread(thread)
+	, _error(false)
+	, _done(false)
+	, _task(0)
+{
+	ls->_last_pending = this;
+}
+
+void Pending::resume(const Value::List &results)
+{
+	if (_done)
+		return;
+
+	_done = true;
+	_results = results;
+	QMetaObject::invokeMethod(this, "deliver", Qt::QueuedConnection);
+}
+
+void Pending::resume()
+{
+	resume(Value::List());
+}
+
+void Pending::fail(const String &error)
+{
+	if (_done)
+		return;
+
+	_done = true;
+	_error = true;
+	_results = Value::List(Value(_ls, error));
+	QMetaObject::invokeMethod(this, "deliver", Qt::QueuedConnection);
+}
+
+void Pending::resume_on(QObject *sender, const char *signal)
+{
+	if (!QObject::connect(sender, signal, this, SLOT(resume())))
+		QTLUA_THROW(QtLua::Pending, "Unable to connect the `%' signal.", .arg(signal));
+}
+
+void Pending::deliver()
+{
+	if (_sched)
+	{
+		_sched->resume_task(_task, _results, _error);
+	}
+	else if (_ls)
+	{
+		try
+		{
+			_ls->resume_pending(_thread, _results, _error);
+		}
+		catch (const String &err)
+		{
+			qDebug() << "Error resuming lua coroutine:" << err;
+		}
+	}
+
+	deleteLater();
+}
+
+}
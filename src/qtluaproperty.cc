@@ -27,7 +27,14 @@ namespace QtLua {
 
 Property::Property(const QMetaObject *mo, int index)
 	: Member(mo, index)
+	, _storage_type(-1)
 {
+	QMetaProperty mp = _mo->property(_index);
+	int type = mp.userType();
+
+	// enums and variant properties need QMetaProperty conversions
+	if (type != 0 && type != QMetaType::QVariant && !mp.isEnumType() && QMetaType::isRegistered(type))
+		_storage_type = type;
 }
 
 void Property::assign(QObjectWrapper &qow, const Value &value)
@@ -46,6 +53,23 @@ void Property::assign(QObjectWrapper &qow, const Value &value)
 	if (!mp.isWritable())
 		QTLUA_THROW(QtLua::Property, "QObject property '%' is read only.", .arg(mp.name()));
 
+	int type = _storage_type;
+
+	if (type >= 0)
+	{
+		// write from typed storage, without QVariant
+		QMetaValue v(type, value);
+		int status = -1;
+		int flags = 0;
+		void *argv[] = { v.get_data(), 0, &status, &flags };
+
+		obj.qt_metacall(QMetaObject::WriteProperty, _index, argv);
+
+		if (!status)
+			QTLUA_THROW(QtLua::Property, "Unable to set value of the '%' QObject property.", .arg(mp.name()));
+		return;
+	}
+
 	if (!mp.write(&obj, QMetaValue(mp.userType(), value).to_qvariant()))
 		QTLUA_THROW(QtLua::Property, "Unable to set value of the '%' QObject property.", .arg(mp.name()));
 }
@@ -58,6 +82,22 @@ Value Property::access(QObjectWrapper &qow)
 	if (!mp.isReadable())
 		QTLUA_THROW(QtLua::Property, "QObject property '%' is not readable.", .arg(mp.name()));
 
+	int type = _storage_type;
+
+	if (type >= 0)
+	{
+		// read to typed storage, without QVariant
+		QMetaValue v(type);
+		int status = -1;
+		void *argv[] = { v.get_data(), 0, &status };
+
+		// a non negative id is returned when no class handled the read
+		if (obj.qt_metacall(QMetaObject::ReadProperty, _index, argv) >= 0)
+			QTLUA_THROW(QtLua::Property, "Unable to read a valid value from the '%' QObject property.", .arg(mp.name()));
+
+		return v.to_value(qow.get_state());
+	}
+
 	QVariant variant = mp.read(&obj);
 
 	if (!variant.isValid())
@@ -0,0 +1,255 @@
+/*
+    This file is part of LibQtLua.
+
+    LibQtLua is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibQtLua is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LibQtLua.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright (C) 2008, Alexandre Becoulet <alexandre.becoulet@free.fr>
+
+*/
+
+#include <QDebug>
+
+#include <QtLua/ProxyNotifier>
+#include <QtLua/State>
+
+namespace QtLua {
+
+ProxyNotifier::ProxyNotifier(QObject *parent)
+	: QObject(parent)
+	, _posted(false)
+	, _delivering(0)
+	, _destroyed(false)
+{
+}
+
+void ProxyNotifier::destroy()
+{
+	if (!_delivering)
+	{
+		delete this;
+		return;
+	}
+
+	// deliver() is running from the event loop and still uses this object
+	_destroyed = true;
+	_observers.clear();
+	deleteLater();
+}
+
+void ProxyNotifier::add_observer(const Value &func)
+{
+	if (!_observers.contains(func))
+		_observers.push_back(func);
+}
+
+void ProxyNotifier::remove_observer(const Value &func)
+{
+	_observers.removeAll(func);
+}
+
+bool ProxyNotifier::is_observed() const
+{
+	return !_observers.isEmpty() ||
+		receivers(SIGNAL(changed(QtLua::ProxyNotifier::ChangeList))) > 0;
+}
+
+void ProxyNotifier::notify_changed(int first, int last, ChangeType type)
+{
+	if (first < 1 || last < first || !is_observed())
+		return;
+
+	Change c;
+	c._type = type;
+	c._first = first;
+	c._last = last;
+	post(c);
+}
+
+void ProxyNotifier::notify_changed(const Value &key, ChangeType type)
+{
+	if (!is_observed())
+		return;
+
+	Change c;
+	c._type = type;
+	c._first = c._last = 0;
+	c._key = key;
+	post(c);
+}
+
+bool ProxyNotifier::merge(Change &prev, const Change &change)
+{
+	if (prev._type != change._type)
+		return false;
+
+	// keyed changes are combined in post()
+	if (!prev._first || !change._first)
+		return false;
+
+	int count = change._last - change._first + 1;
+
+	switch (change._type)
+	{
+	case ChangeSet:
+		if (change._first > prev._last + 1 || change._last + 1 < prev._first)
+			return false;
+		prev._first = qMin(prev._first, change._first);
+		prev._last = qMax(prev._last, change._last);
+		return true;
+
+	case ChangeInsert:
+		if (change._first < prev._first || change._first > prev._last + 1)
+			return false;
+		prev._last += count;
+		return true;
+
+	case ChangeRemove:
+		// indexes of a removal refer to the container after previous removals
+		if (change._first == prev._first)
+			prev._last += count;
+		else if (change._last + 1 == prev._first)
+			prev._first = change._first;
+		else
+			return false;
+		return true;
+	}
+
+	return false;
+}
+
+void ProxyNotifier::post(const Change &change)
+{
+	if (!change._first)
+	{
+		QHash<Value, int>::const_iterator i = _pending_keys.constFind(change._key);
+
+		if (i != _pending_keys.constEnd())
+		{
+			// one record per key with the net change type
+			int index = i.value();
+			Change &prev = _pending[index];
+
+			if (prev._type == ChangeInsert && change._type == ChangeRemove)
+			{
+				// key did not exist before, the changes cancel out
+				_pending.removeAt(index);
+				_pending_keys.remove(change._key);
+
+				for (QHash<Value, int>::iterator j = _pending_keys.begin(); j != _pending_keys.end(); ++j)
+					if (j.value() > index)
+						j.value()--;
+			}
+			else if (prev._type == ChangeRemove && change._type == ChangeInsert)
+				prev._type = ChangeSet;
+			else if (prev._type != ChangeInsert || change._type != ChangeSet)
+				prev._type = change._type;
+			return;
+		}
+
+		_pending_keys.insert(change._key, _pending.size());
+	}
+	else if (!_pending.isEmpty() && merge(_pending.last(), change))
+	{
+		return;
+	}
+
+	_pending.push_back(change);
+
+	if (!_posted)
+	{
+		_posted = true;
+		QMetaObject::invokeMethod(this, "deliver", Qt::QueuedConnection);
+	}
+}
+
+Value ProxyNotifier::to_table(State *ls, const ChangeList &changes)
+{
+	static const char *names[] = { "set", "insert", "remove" };
+	Value::List records;
+
+	records.reserve(changes.size());
+	foreach(const Change &c, changes)
+	{
+		Value record(Value::new_table(ls, 0, 3));
+
+		record["type"] = names[c._type];
+		if (c._first)
+		{
+			record["first"] = c._first;
+			record["last"] = c._last;
+		}
+		else
+		{
+			record["key"] = Value(ls, c._key);
+		}
+		records.push_back(record);
+	}
+
+	Value table(Value::new_table(ls, records.size()));
+	table.table_raw_set(1, records);
+	return table;
+}
+
+void ProxyNotifier::deliver()
+{
+	ChangeList changes(_pending);
+
+	_pending.clear();
+	_pending_keys.clear();
+	_posted = false;
+
+	if (changes.isEmpty())
+		return;
+
+	// the proxy, and this notifier, may be destroyed by any observer
+	_delivering++;
+
+	emit changed(changes);
+
+	// observers may register or unregister while being called
+	Value::List observers(_observers);
+	State *table_ls = 0;
+	Value table;
+
+	foreach(const Value &func, observers)
+	{
+		if (_destroyed)
+			break;
+
+		State *ls = func.get_state();
+
+		if (!ls)
+			continue;
+
+		try
+		{
+			if (ls != table_ls)
+			{
+				table = to_table(ls, changes);
+				table_ls = ls;
+			}
+
+			func.call(Value::List(table));
+		}
+		catch (const String &err)
+		{
+			qDebug() << "Error in lua container observer:" << err;
+		}
+	}
+
+	_delivering--;
+}
+
+}
+
@@ -39,6 +39,10 @@
 #include <internal/QObjectWrapper>
 #include <internal/QMetaValue>
 
+extern "C" {
+#include <lua.h>
+}
+
 namespace QtLua {
 
 metatype_map_t types_map;
@@ -241,7 +245,7 @@ void QMetaValue::raw_set_object(int type, void *data, const Value &v)
 		*(double *)data = v.to_number();
 		break;
 	case QMetaType::Float:
-		*(double *)data = v.to_number();
+		*(float *)data = v.to_number();
 		break;
 	case QMetaType::QChar:
 		*reinterpret_cast<QChar *>(data) = QChar((unsigned short)v.to_number());
@@ -434,4 +438,370 @@ void QMetaValue::raw_set_object(int type, void *data, const Value &v)
 	}
 }
 
+static void push_numbers(lua_State *st, const lua_Number *n, int count)
+{
+	lua_createtable(st, count, 0);
+
+	for (int i = 0; i < count; i++)
+	{
+		lua_pushnumber(st, n[i]);
+		lua_rawseti(st, -2, i + 1);
+	}
+}
+
+void QMetaValue::raw_push_object(State *ls, lua_State *st, int type, const void *data)
+{
+	switch (type)
+	{
+	case QMetaType::Void:
+		lua_pushnil(st);
+		break;
+	case QMetaType::Bool:
+		lua_pushboolean(st, *(bool *)data);
+		break;
+	case QMetaType::Int:
+		lua_pushnumber(st, *(int *)data);
+		break;
+	case QMetaType::UInt:
+		lua_pushnumber(st, *(unsigned int *)data);
+		break;
+	case QMetaType::Long:
+		lua_pushnumber(st, *(long *)data);
+		break;
+	case QMetaType::LongLong:
+		lua_pushnumber(st, *(long long *)data);
+		break;
+	case QMetaType::Short:
+		lua_pushnumber(st, *(short *)data);
+		break;
+	case QMetaType::Char:
+		lua_pushnumber(st, *(char *)data);
+		break;
+	case QMetaType::ULong:
+		lua_pushnumber(st, *(unsigned long *)data);
+		break;
+	case QMetaType::ULongLong:
+		lua_pushnumber(st, *(unsigned long long *)data);
+		break;
+	case QMetaType::UShort:
+		lua_pushnumber(st, *(unsigned short *)data);
+		break;
+	case QMetaType::UChar:
+		lua_pushnumber(st, *(unsigned char *)data);
+		break;
+	case QMetaType::Double:
+		lua_pushnumber(st, *(double *)data);
+		break;
+	case QMetaType::Float:
+		lua_pushnumber(st, *(float *)data);
+		break;
+	case QMetaType::QChar:
+		lua_pushnumber(st, reinterpret_cast<const QChar *>(data)->unicode());
+		break;
+	case QMetaType::QString:
+	{
+		String str(*reinterpret_cast<const QString *>(data));
+		lua_pushlstring(st, str.constData(), str.size());
+		break;
+	}
+	case QMetaType::QStringList:
+	{
+		const QStringList *qsl = reinterpret_cast<const QStringList *>(data);
+		lua_createtable(st, qsl->size(), 0);
+		for (int i = 0; i < qsl->size(); i++)
+		{
+			String str(qsl->at(i));
+			lua_pushlstring(st, str.constData(), str.size());
+			lua_rawseti(st, -2, i + 1);
+		}
+		break;
+	}
+	case QMetaType::QByteArray:
+	{
+		const QByteArray *ba = reinterpret_cast<const QByteArray *>(data);
+		lua_pushlstring(st, ba->constData(), ba->size());
+		break;
+	}
+	case QMetaType::QSize:
+	{
+		const QSize *size = reinterpret_cast<const QSize *>(data);
+		lua_Number n[2] = { (lua_Number)size->width(), (lua_Number)size->height() };
+		push_numbers(st, n, 2);
+		break;
+	}
+	case QMetaType::QSizeF:
+	{
+		const QSizeF *size = reinterpret_cast<const QSizeF *>(data);
+		lua_Number n[2] = { size->width(), size->height() };
+		push_numbers(st, n, 2);
+		break;
+	}
+	case QMetaType::QRect:
+	{
+		const QRect *rect = reinterpret_cast<const QRect *>(data);
+		lua_Number n[4] = { (lua_Number)rect->x(), (lua_Number)rect->y(),
+							(lua_Number)rect->width(), (lua_Number)rect->height() };
+		push_numbers(st, n, 4);
+		break;
+	}
+	case QMetaType::QRectF:
+	{
+		const QRectF *rect = reinterpret_cast<const QRectF *>(data);
+		lua_Number n[4] = { rect->x(), rect->y(), rect->width(), rect->height() };
+		push_numbers(st, n, 4);
+		break;
+	}
+	case QMetaType::QPoint:
+	{
+		const QPoint *point = reinterpret_cast<const QPoint *>(data);
+		lua_Number n[2] = { (lua_Number)point->x(), (lua_Number)point->y() };
+		push_numbers(st, n, 2);
+		break;
+	}
+	case QMetaType::QPointF:
+	{
+		const QPointF *point = reinterpret_cast<const QPointF *>(data);
+		lua_Number n[2] = { point->x(), point->y() };
+		push_numbers(st, n, 2);
+		break;
+	}
+	case QMetaType::QColor:
+	{
+		const QColor *color = reinterpret_cast<const QColor *>(data);
+		lua_Number n[3] = { (lua_Number)color->red(), (lua_Number)color->green(), (lua_Number)color->blue() };
+		push_numbers(st, n, 3);
+		break;
+	}
+	case QMetaType::QCursor:
+		lua_pushnumber(st, reinterpret_cast<const QCursor *>(data)->shape());
+		break;
+	case QMetaType::QPalette:
+	{
+		const QPalette *palette = reinterpret_cast<const QPalette *>(data);
+		lua_createtable(st, QPalette::NColorRoles, 0);
+		for (int i = QPalette::WindowText; i < QPalette::NColorRoles; ++i)
+		{
+			lua_createtable(st, 0, 2);
+			lua_pushnumber(st, i);
+			lua_setfield(st, -2, "role");
+			lua_pushnumber(st, palette->color((QPalette::ColorRole)i).rgb() & 0x00FFFFFF);
+			lua_setfield(st, -2, "color");
+			lua_rawseti(st, -2, i + 1);
+		}
+		break;
+	}
+	default:
+		// wrapped objects, pixmaps and user types
+		raw_get_object(ls, type, data).push_value(st);
+		break;
+	}
+}
+
+static bool number_to_qt(int type, void *data, lua_Number n)
+{
+	switch (type)
+	{
+	case QMetaType::Int:
+		*(int *)data = n;
+		return true;
+	case QMetaType::UInt:
+		*(unsigned int *)data = n;
+		return true;
+	case QMetaType::Long:
+		*(long *)data = n;
+		return true;
+	case QMetaType::LongLong:
+		*(long long *)data = n;
+		return true;
+	case QMetaType::Short:
+		*(short *)data = n;
+		return true;
+	case QMetaType::Char:
+		*(char *)data = n;
+		return true;
+	case QMetaType::ULong:
+		*(unsigned long *)data = n;
+		return true;
+	case QMetaType::ULongLong:
+		*(unsigned long long *)data = n;
+		return true;
+	case QMetaType::UShort:
+		*(unsigned short *)data = n;
+		return true;
+	case QMetaType::UChar:
+		*(unsigned char *)data = n;
+		return true;
+	case QMetaType::Double:
+		*(double *)data = n;
+		return true;
+	case QMetaType::Float:
+		*(float *)data = n;
+		return true;
+	case QMetaType::QChar:
+		*reinterpret_cast<QChar *>(data) = QChar((unsigned short)n);
+		return true;
+	default:
+		return false;
+	}
+}
+
+static bool table_numbers(lua_State *st, int index, lua_Number *n, int count)
+{
+	for (int i = 0; i < count; i++)
+	{
+		lua_rawgeti(st, index, i + 1);
+		bool ok = lua_type(st, -1) == LUA_TNUMBER;
+		n[i] = lua_tonumber(st, -1);
+		lua_pop(st, 1);
+		if (!ok)
+			return false;
+	}
+
+	return true;
+}
+
+static bool table_to_qt(int type, void *data, lua_State *st, int index)
+{
+	// tables with metatable may provide entries through __index
+	if (lua_getmetatable(st, index))
+	{
+		lua_pop(st, 1);
+		return false;
+	}
+
+	lua_Number n[4];
+
+	switch (type)
+	{
+	case QMetaType::QStringList:
+	{
+		QStringList *qsl = reinterpret_cast<QStringList *>(data);
+		for (int i = 1;; i++)
+		{
+			lua_rawgeti(st, index, i);
+			switch (lua_type(st, -1))
+			{
+			case LUA_TNIL:
+				lua_pop(st, 1);
+				return true;
+			case LUA_TSTRING:
+			{
+				size_t len;
+				const char *str = lua_tolstring(st, -1, &len);
+				qsl->push_back(QString::fromUtf8(str, len));
+				lua_pop(st, 1);
+				break;
+			}
+			default:
+				lua_pop(st, 1);
+				qsl->clear();
+				return false;
+			}
+		}
+	}
+	case QMetaType::QSize:
+	{
+		if (!table_numbers(st, index, n, 2))
+			return false;
+		QSize *size = reinterpret_cast<QSize *>(data);
+		size->setWidth(n[0]);
+		size->setHeight(n[1]);
+		return true;
+	}
+	case QMetaType::QSizeF:
+	{
+		if (!table_numbers(st, index, n, 2))
+			return false;
+		QSizeF *size = reinterpret_cast<QSizeF *>(data);
+		size->setWidth(n[0]);
+		size->setHeight(n[1]);
+		return true;
+	}
+	case QMetaType::QRect:
+	{
+		if (!table_numbers(st, index, n, 4))
+			return false;
+		QRect *rect = reinterpret_cast<QRect *>(data);
+		rect->setX(n[0]);
+		rect->setY(n[1]);
+		rect->setWidth(n[2]);
+		rect->setHeight(n[3]);
+		return true;
+	}
+	case QMetaType::QRectF:
+	{
+		if (!table_numbers(st, index, n, 4))
+			return false;
+		QRectF *rect = reinterpret_cast<QRectF *>(data);
+		rect->setX(n[0]);
+		rect->setY(n[1]);
+		rect->setWidth(n[2]);
+		rect->setHeight(n[3]);
+		return true;
+	}
+	case QMetaType::QPoint:
+	{
+		if (!table_numbers(st, index, n, 2))
+			return false;
+		QPoint *point = reinterpret_cast<QPoint *>(data);
+		point->setX(n[0]);
+		point->setY(n[1]);
+		return true;
+	}
+	case QMetaType::QPointF:
+	{
+		if (!table_numbers(st, index, n, 2))
+			return false;
+		QPointF *point = reinterpret_cast<QPointF *>(data);
+		point->setX(n[0]);
+		point->setY(n[1]);
+		return true;
+	}
+	default:
+		return false;
+	}
+}
+
+void QMetaValue::raw_set_object(int type, void *data, State *ls, lua_State *st, int index)
+{
+	if (index < 0)
+		index = lua_gettop(st) + index + 1;
+
+	switch (lua_type(st, index))
+	{
+	case LUA_TNUMBER:
+		if (number_to_qt(type, data, lua_tonumber(st, index)))
+			return;
+		break;
+
+	case LUA_TSTRING:
+		if (type == QMetaType::QString || type == QMetaType::QByteArray)
+		{
+			size_t len;
+			const char *str = lua_tolstring(st, index, &len);
+
+			if (type == QMetaType::QString)
+				*reinterpret_cast<QString *>(data) = QString::fromUtf8(str, len);
+			else
+				*reinterpret_cast<QByteArray *>(data) = QByteArray(str, len);
+			return;
+		}
+		break;
+
+	case LUA_TTABLE:
+		if (table_to_qt(type, data, st, index))
+			return;
+		break;
+	}
+
+	if (type == QMetaType::Bool)
+	{
+		*(bool *)data = lua_toboolean(st, index);
+		return;
+	}
+
+	// other conversions follow the generic lua value rules
+	raw_set_object(type, data, Value(index, ls));
+}
+
 }
@@ -20,7 +20,12 @@
 
 #include <QDebug>
 #include <QObject>
+#include <QEvent>
+#include <QTimerEvent>
+#include <QCoreApplication>
+#include <QThread>
 #include <QMetaObject>
+#include <QMutexLocker>
 #include <QWidget>
 
 #include <internal/QObjectWrapper>
@@ -29,6 +34,10 @@
 #include <internal/MetaCache>
 #include <internal/QObjectIterator>
 
+extern "C" {
+#include <lua.h>
+}
+
 #define Q_ASSERT_DO(x)              \
 	{                               \
 		bool res_ = (x);            \
@@ -39,10 +48,47 @@ namespace QtLua {
 
 static const int destroyindex = QObject::staticMetaObject.indexOfSignal("destroyed()");
 
+// posted to deliver coalesced signal emissions on next event loop iteration
+static const QEvent::Type flush_event = (QEvent::Type)QEvent::registerEventType();
+// posted to deliver queued signal emissions, and emissions from other threads
+static const QEvent::Type queue_event = (QEvent::Type)QEvent::registerEventType();
+
+// QObject user data slot used to find wrappers from their QObject
+static const uint wrapper_data_id = QObject::registerUserData();
+
+// QObjects may be wrapped by State objects living in different
+// threads, guards wrapper chains of all objects
+static QMutex wrapper_data_lock;
+
+/** @internal Wrappers of a QObject, one for each State */
+struct QObjectWrapperData : public QObjectUserData
+{
+	QObjectWrapperData()
+		: _first(0)
+	{
+	}
+
+	~QObjectWrapperData()
+	{
+		// QObject is being destroyed, wrappers must not refer to us anymore
+		QMutexLocker locker(&wrapper_data_lock);
+
+		for (QObjectWrapper *w = _first; w; w = w->_obj_next)
+			w->_obj_data = 0;
+	}
+
+	QObjectWrapper *_first;
+};
+
 QObjectWrapper::QObjectWrapper(State *ls, QObject *obj)
 	: _ls(ls)
 	, _obj(obj)
+	, _obj_data(0)
+	, _obj_next(0)
+	, _ls_prev(0)
+	, _ls_next(0)
 	, _lua_next_slot(1)
+	, _flush_posted(false)
 	, _reparent(false)
 	, _delete(obj && obj->parent())
 {
@@ -54,7 +100,7 @@ QObjectWrapper::QObjectWrapper(State *ls, QObject *obj)
 	{
 		Q_ASSERT_DO(QMetaObject::connect(obj, destroyindex, this, metaObject()->methodCount() + 0));
 
-		ls->_whash.insert(obj, this);
+		attach();
 		// increment reference count since we are bound to a qobject
 		_inc();
 	}
@@ -68,10 +114,13 @@ Ref<QObjectWrapper> QObjectWrapper::get_wrapper(State *ls, QObject *obj)
 
 	if (obj)
 	{
-		wrapper_hash_t::iterator i = ls->_whash.find(obj);
+		QMutexLocker locker(&wrapper_data_lock);
+		QObjectWrapperData *d = static_cast<QObjectWrapperData *>(obj->userData(wrapper_data_id));
 
-		if (i != ls->_whash.end())
-			return *i.value();
+		if (d)
+			for (QObjectWrapper *w = d->_first; w; w = w->_obj_next)
+				if (w->_ls == ls)
+					return *w;
 	}
 
 	QObjectWrapper::ptr qow = QTLUA_REFNEW(QObjectWrapper, ls, obj);
@@ -89,6 +138,58 @@ Ref<QObjectWrapper> QObjectWrapper::get_wrapper(State *ls, QObject *obj, bool re
 	return qow;
 }
 
+void QObjectWrapper::attach()
+{
+	QMutexLocker locker(&wrapper_data_lock);
+	QObjectWrapperData *d = static_cast<QObjectWrapperData *>(_obj->userData(wrapper_data_id));
+
+	if (!d)
+	{
+		d = new QObjectWrapperData();
+		_obj->setUserData(wrapper_data_id, d);
+	}
+
+	_obj_data = d;
+	_obj_next = d->_first;
+	d->_first = this;
+
+	_ls_prev = 0;
+	_ls_next = _ls->_wrappers;
+	if (_ls_next)
+		_ls_next->_ls_prev = this;
+	_ls->_wrappers = this;
+}
+
+void QObjectWrapper::detach()
+{
+	QMutexLocker locker(&wrapper_data_lock);
+
+	if (_obj_data)
+	{
+		for (QObjectWrapper **w = &_obj_data->_first; *w; w = &(*w)->_obj_next)
+		{
+			if (*w == this)
+			{
+				*w = _obj_next;
+				break;
+			}
+		}
+	}
+
+	_obj_data = 0;
+	_obj_next = 0;
+
+	if (_ls_prev)
+		_ls_prev->_ls_next = _ls_next;
+	else
+		_ls->_wrappers = _ls_next;
+
+	if (_ls_next)
+		_ls_next->_ls_prev = _ls_prev;
+
+	_ls_prev = _ls_next = 0;
+}
+
 void QObjectWrapper::obj_destroyed()
 {
 #ifdef QTLUA_QOBJECTWRAPPER_DEBUG
@@ -96,7 +197,7 @@ void QObjectWrapper::obj_destroyed()
 #endif
 	Q_ASSERT(_obj = sender());
 
-	Q_ASSERT_DO(_ls->_whash.remove(_obj));
+	detach();
 	_obj = 0;
 	_drop();
 }
@@ -109,7 +210,7 @@ QObjectWrapper::~QObjectWrapper()
 
 	if (_obj)
 	{
-		Q_ASSERT_DO(_ls->_whash.remove(_obj));
+		detach();
 
 		Q_ASSERT_DO(QMetaObject::disconnect(_obj, destroyindex, this, metaObject()->methodCount() + 0));
 
@@ -152,37 +253,282 @@ int QObjectWrapper::qt_metacall(QMetaObject::Call c, int id, void **qt_args)
 	if (!_obj)
 		return -1;
 
+	if (QThread::currentThread() != thread())
+	{
+		// emitted from an other thread, lua can only be used from the
+		// wrapper thread event loop
+		QMutexLocker locker(&_queue_lock);
+		lua_slot_enqueue(id, qt_args);
+		return -1;
+	}
+
+	Q_ASSERT(_obj == sender());
+
 	lua_slots_hash_t::iterator i = _lua_slots.find(id);
-	Q_ASSERT(i != _lua_slots.end());
+
+	if (i == _lua_slots.end())
+		return -1;
+
+	if (i.value()._mode == Value::ConnectQueued)
+	{
+		QMutexLocker locker(&_queue_lock);
+		lua_slot_enqueue(id, qt_args);
+	}
+	else
+	{
+		lua_slot_dispatch(id, qt_args);
+	}
+
+	return -1;
+}
+
+void QObjectWrapper::lua_slot_enqueue(int slot_id, void **qt_args)
+{
+	// called with _queue_lock held, slot may be disconnected concurrently
+	lua_slots_hash_t::const_iterator i = _lua_slots.constFind(slot_id);
+
+	if (i == _lua_slots.constEnd())
+		return;
+
+	// copy arguments, they are only valid during the emission
+	QueuedEmission e;
+	e._slot_id = slot_id;
+
+	for (int j = 0; j < i.value()._param_types.size(); j++)
+		e._args.append(QVariant(i.value()._param_types[j], qt_args[j + 1]));
+
+	// a single event delivers all emissions queued during a loop turn
+	if (_queue.isEmpty())
+		QCoreApplication::postEvent(this, new QEvent(queue_event));
+
+	_queue.append(e);
+}
+
+void QObjectWrapper::lua_slot_dispatch(int slot_id, void **qt_args)
+{
+	lua_slots_hash_t::iterator i = _lua_slots.find(slot_id);
+
+	// may have been disconnected while queued
+	if (i == _lua_slots.end() || !_obj)
+		return;
+
+	LuaSlot &slot = i.value();
+
+	if (slot._mode == Value::ConnectLatest || slot._mode == Value::ConnectBatch)
+	{
+		// record raw emission arguments, lua values are only built on delivery
+		QList<QVariant> raw_args;
+
+		for (int j = 0; j < slot._param_types.size(); j++)
+			raw_args.append(QVariant(slot._param_types[j], qt_args[j + 1]));
+
+		if (slot._mode == Value::ConnectLatest)
+			slot._pending.clear();
+		slot._pending.append(raw_args);
+
+		lua_slot_schedule(slot);
+		return;
+	}
+
+	if (slot._function)
+	{
+		// call lua function with arguments converted directly on lua stack
+		lua_State *lst = _ls->_lst;
+		int oldtop = lua_gettop(lst);
+		int count = slot._param_types.size();
+
+		try
+		{
+			if (!lua_checkstack(lst, count + 2))
+				QTLUA_THROW(QtLua::QObjectWrapper, "Unable to extend the lua stack to handle % arguments.",
+							.arg(count + 1));
+
+			slot._value.push_value(lst);
+
+			// first arg is sender object
+			push_ud(lst);
+
+			for (int j = 0; j < count; j++)
+				QMetaValue::raw_push_object(_ls, lst, slot._param_types[j], qt_args[j + 1]);
+
+			// slot may be disconnected and destroyed from here
+			if (lua_pcall(lst, count + 1, 0, 0))
+			{
+				String err(lua_tostring(lst, -1));
+				throw err;
+			}
+		}
+		catch (const String &err)
+		{
+			qDebug() << "Error executing lua slot:" << err;
+		}
+
+		lua_settop(lst, oldtop);
+		return;
+	}
+
+	Value::List lua_args;
+
+	// first arg is sender object
+	lua_args.push_back(Value(_ls, QObjectWrapper::get_wrapper(_ls, _obj)));
+
+	for (int j = 0; j < slot._param_types.size(); j++)
+		lua_args.push_back(QMetaValue::raw_get_object(_ls, slot._param_types[j], qt_args[j + 1]));
+
+	Value value(slot._value);
+
+	try
+	{
+		value.call(lua_args);
+	}
+	catch (const String &err)
+	{
+		qDebug() << "Error executing lua slot:" << err;
+	}
+}
+
+void QObjectWrapper::lua_slot_schedule(LuaSlot &slot)
+{
+	if (slot._scheduled)
+		return;
+
+	slot._scheduled = true;
+
+	if (slot._interval > 0)
+	{
+		slot._timer_id = startTimer(slot._interval);
+	}
+	else if (!_flush_posted)
+	{
+		_flush_posted = true;
+		QCoreApplication::postEvent(this, new QEvent(flush_event));
+	}
+}
+
+void QObjectWrapper::lua_slot_cancel(LuaSlot &slot)
+{
+	if (slot._timer_id)
+		killTimer(slot._timer_id);
+
+	slot._timer_id = 0;
+	slot._scheduled = false;
+	slot._pending.clear();
+}
+
+void QObjectWrapper::lua_slot_deliver(int slot_id)
+{
+	lua_slots_hash_t::iterator i = _lua_slots.find(slot_id);
+
+	if (i == _lua_slots.end())
+		return;
+
+	LuaSlot &slot = i.value();
+	QList<QList<QVariant> > pending = slot._pending;
+	QVector<int> types = slot._param_types;
+	Value::ConnectMode mode = slot._mode;
+	Value value(slot._value);
+
+	lua_slot_cancel(slot);
+
+	if (!_obj || pending.isEmpty())
+		return;
 
 	Value::List lua_args;
 
 	// first arg is sender object
-	Q_ASSERT(_obj == sender());
 	lua_args.push_back(Value(_ls, QObjectWrapper::get_wrapper(_ls, _obj)));
 
-	// push more args from parameter type informations
-	QMetaMethod mm = _obj->metaObject()->method(i.value()._sigindex);
+	if (mode == Value::ConnectBatch)
+	{
+		Value batch(Value::new_table(_ls));
+
+		for (int j = 0; j < pending.size(); j++)
+		{
+			Value emission(Value::new_table(_ls));
+
+			for (int k = 0; k < pending[j].size(); k++)
+				emission[k + 1] = QMetaValue::raw_get_object(_ls, types[k], pending[j][k].constData());
+
+			batch[j + 1] = emission;
+		}
 
-	foreach (const QByteArray &pt, mm.parameterTypes())
+		lua_args.push_back(batch);
+	}
+	else
 	{
-		qt_args++;
-		lua_args.push_back(QMetaValue::raw_get_object(_ls, QMetaType::type(pt.constData()), *qt_args));
+		const QList<QVariant> &last = pending.last();
+
+		for (int k = 0; k < last.size(); k++)
+			lua_args.push_back(QMetaValue::raw_get_object(_ls, types[k], last[k].constData()));
 	}
 
 	try
 	{
-		i.value()._value.call(lua_args);
+		value.call(lua_args);
 	}
 	catch (const String &err)
 	{
 		qDebug() << "Error executing lua slot:" << err;
 	}
+}
 
-	return -1;
+void QObjectWrapper::customEvent(QEvent *event)
+{
+	if (event->type() == queue_event)
+	{
+		QList<QueuedEmission> queue;
+
+		{
+			QMutexLocker locker(&_queue_lock);
+			queue.swap(_queue);
+		}
+
+		// deliver all emissions queued since last event loop turn, a
+		// previous handler may have disconnected some slots
+		foreach (const QueuedEmission &e, queue)
+		{
+			QVector<void *> qt_args(e._args.size() + 1);
+
+			for (int j = 0; j < e._args.size(); j++)
+				qt_args[j + 1] = const_cast<void *>(e._args[j].constData());
+
+			lua_slot_dispatch(e._slot_id, qt_args.data());
+		}
+
+		return;
+	}
+
+	if (event->type() != flush_event)
+		return QObject::customEvent(event);
+
+	_flush_posted = false;
+
+	QList<int> ids;
+
+	for (lua_slots_hash_t::const_iterator i = _lua_slots.begin(); i != _lua_slots.end(); ++i)
+		if (i.value()._scheduled && !i.value()._timer_id)
+			ids.append(i.key());
+
+	// lua handlers may connect or disconnect slots
+	foreach (int id, ids)
+		lua_slot_deliver(id);
 }
 
-void QObjectWrapper::_lua_connect(int sigindex, const Value &value)
+void QObjectWrapper::timerEvent(QTimerEvent *event)
+{
+	for (lua_slots_hash_t::const_iterator i = _lua_slots.begin(); i != _lua_slots.end(); ++i)
+	{
+		if (i.value()._timer_id == event->timerId())
+		{
+			lua_slot_deliver(i.key());
+			return;
+		}
+	}
+
+	QObject::timerEvent(event);
+}
+
+void QObjectWrapper::_lua_connect(int sigindex, const Value &value, Value::ConnectMode mode, int interval)
 {
 	get_object();
 
@@ -191,16 +537,26 @@ void QObjectWrapper::_lua_connect(int sigindex, const Value &value)
 	case Value::TUserData:
 	case Value::TFunction:
 	{
-		int slot_id;
+		int slot_id = _lua_next_slot++;
 
-		do
+		// slot is invoked in the emitting thread, see qt_metacall
+		if (QMetaObject::connect(_obj, sigindex, this, metaObject()->methodCount() + slot_id, Qt::DirectConnection))
 		{
-			slot_id = _lua_next_slot++;
-		} while (_lua_slots.contains(slot_id));
+			LuaSlot slot(value, sigindex);
+			slot._function = value.type() == Value::TFunction;
+			slot._mode = mode;
+			slot._interval = interval;
 
-		if (QMetaObject::connect(_obj, sigindex, this, metaObject()->methodCount() + slot_id))
-		{
-			_lua_slots.insert(slot_id, LuaSlot(value, sigindex));
+			// resolve signal parameter types once
+			QMetaMethod mm = _obj->metaObject()->method(sigindex);
+			foreach (const QByteArray &pt, mm.parameterTypes())
+				slot._param_types.append(QMetaType::type(pt.constData()));
+
+			_lua_slots_by_signal.insert(sigindex, slot_id);
+			_lua_slots_by_value.insert(value, slot_id);
+
+			QMutexLocker locker(&_queue_lock);
+			_lua_slots.insert(slot_id, slot);
 			return;
 		}
 
@@ -213,25 +569,50 @@ void QObjectWrapper::_lua_connect(int sigindex, const Value &value)
 	}
 }
 
+void QObjectWrapper::lua_slot_remove(lua_slots_hash_t::iterator i)
+{
+	int slot_id = i.key();
+	LuaSlot &slot = i.value();
+
+	bool ok = QMetaObject::disconnect(_obj, slot._sigindex, this, metaObject()->methodCount() + slot_id);
+	Q_ASSERT(ok);
+
+	lua_slot_cancel(slot);
+	_lua_slots_by_signal.remove(slot._sigindex, slot_id);
+	_lua_slots_by_value.remove(slot._value, slot_id);
+
+	QMutexLocker locker(&_queue_lock);
+
+	// drop emissions queued for this slot
+	for (QList<QueuedEmission>::iterator j = _queue.begin(); j != _queue.end();)
+	{
+		if (j->_slot_id == slot_id)
+			j = _queue.erase(j);
+		else
+			++j;
+	}
+
+	_lua_slots.erase(i);
+}
+
 bool QObjectWrapper::_lua_disconnect(int sigindex, const Value &value)
 {
 	if (!_obj)
 		return false;
 
-	lua_slots_hash_t::iterator i;
+	lua_slots_value_index_t::const_iterator j;
 
-	for (i = _lua_slots.begin(); i != _lua_slots.end();)
+	for (j = _lua_slots_by_value.constFind(value);
+		 j != _lua_slots_by_value.constEnd() && j.key() == value; ++j)
 	{
-		if (i.value()._sigindex == sigindex && value == i.value()._value)
+		lua_slots_hash_t::iterator i = _lua_slots.find(j.value());
+		Q_ASSERT(i != _lua_slots.end());
+
+		if (i.value()._sigindex == sigindex)
 		{
-			bool ok = QMetaObject::disconnect(_obj, sigindex, this, metaObject()->methodCount() + i.key());
-			Q_ASSERT(ok);
-			_lua_next_slot = qMin(_lua_next_slot, i.key());
-			i = _lua_slots.erase(i);
+			lua_slot_remove(i);
 			return true;
 		}
-		else
-			++i;
 	}
 
 	return false;
@@ -242,20 +623,8 @@ void QObjectWrapper::_lua_disconnect_all(int sigindex)
 	if (!_obj)
 		return;
 
-	lua_slots_hash_t::iterator i;
-
-	for (i = _lua_slots.begin(); i != _lua_slots.end();)
-	{
-		if (i.value()._sigindex == sigindex)
-		{
-			bool ok = QMetaObject::disconnect(_obj, sigindex, this, metaObject()->methodCount() + i.key());
-			Q_ASSERT(ok);
-			_lua_next_slot = qMin(_lua_next_slot, i.key());
-			i = _lua_slots.erase(i);
-		}
-		else
-			++i;
-	}
+	foreach (int slot_id, _lua_slots_by_signal.values(sigindex))
+		lua_slot_remove(_lua_slots.find(slot_id));
 }
 
 void QObjectWrapper::_lua_disconnect_all()
@@ -263,23 +632,23 @@ void QObjectWrapper::_lua_disconnect_all()
 	if (!_obj)
 		return;
 
-	lua_slots_hash_t::iterator i;
-
-	for (i = _lua_slots.begin(); i != _lua_slots.end();)
-	{
-		bool ok = QMetaObject::disconnect(_obj, i.value()._sigindex, this, metaObject()->methodCount() + i.key());
-		Q_ASSERT(ok);
-		++i;
-	}
-	_lua_slots.clear();
-	_lua_next_slot = 1;
+	while (!_lua_slots.isEmpty())
+		lua_slot_remove(_lua_slots.begin());
 }
 
 QObject *QObjectWrapper::get_child(QObject &obj, const String &name)
 {
+	QString qname(name.to_qstring());
+
 	foreach (QObject *child, obj.children())
-		if (QObjectWrapper::qobject_name(*child) == name)
+	{
+		// do not assign generated names to unnamed children here
+		const QString &cname = child->objectName();
+
+		if (cname.isEmpty() ? qobject_default_name(*child) == qname : cname == qname)
 			return child;
+	}
+
 	return 0;
 }
 
@@ -288,14 +657,17 @@ Value QObjectWrapper::meta_index(State *ls, const Value &key)
 	QObject &obj = get_object();
 	String skey = key.to_string();
 
-	// handle children access
+	// member read access, members take precedence over children
+	Member::ptr m = MetaCache::get_meta(obj).get_member(skey);
+
+	if (m.valid())
+		return m->access(*this);
+
+	// fallback to children access
 	if (QObject *child = get_child(obj, skey))
 		return Value(ls, QObjectWrapper::get_wrapper(ls, child));
 
-	// fallback to member read access
-	Member::ptr m = MetaCache::get_meta(obj).get_member(skey);
-
-	return m.valid() ? m->access(*this) : Value(ls);
+	return Value(ls);
 }
 
 void QObjectWrapper::reparent(QObject *parent)
@@ -317,6 +689,23 @@ void QObjectWrapper::meta_newindex(State *ls, const Value &key, const Value &val
 	QObject &obj = get_object();
 	String skey = key.to_string();
 
+	// member write access, members take precedence over children
+	Member::ptr m = MetaCache::get_meta(obj).get_member(skey);
+
+	if (m.valid())
+	{
+		m->assign(*this, value);
+		return;
+	}
+	else if (obj.isWidgetType())
+	{
+		if (skey == "windowFlags")
+		{
+			qobject_cast<QWidget *>(&obj)->setWindowFlags((Qt::WindowFlags)value.to_integer());
+			return;
+		}
+	}
+
 	// handle existing children access
 	if (QObject *cobj = get_child(obj, skey))
 	{
@@ -336,25 +725,6 @@ void QObjectWrapper::meta_newindex(State *ls, const Value &key, const Value &val
 		vw->reparent(&obj);
 		return;
 	}
-	else
-	{
-		// fallback to member write access
-		Member::ptr m = MetaCache::get_meta(obj).get_member(skey);
-
-		if (m.valid())
-		{
-			m->assign(*this, value);
-			return;
-		}
-		else if (obj.isWidgetType())
-		{
-			if (skey == "windowFlags")
-			{
-				qobject_cast<QWidget *>(&obj)->setWindowFlags((Qt::WindowFlags)value.to_integer());
-				return;
-			}
-		}
-	}
 
 	// child insertion
 	QObjectWrapper::ptr vw = value.to_userdata_cast<QObjectWrapper>();
@@ -405,15 +775,18 @@ void QObjectWrapper::completion_patch(String &path, String &entry, int &offset)
 		entry += ".";
 }
 
+QString QObjectWrapper::qobject_default_name(const QObject &obj)
+{
+	QString name;
+
+	name.sprintf("%s_%lx", obj.metaObject()->className(), (unsigned long)&obj);
+	return name.toLower();
+}
+
 String QObjectWrapper::qobject_name(QObject &obj)
 {
 	if (obj.objectName().isEmpty())
-	{
-		QString name;
-
-		name.sprintf("%s_%lx", obj.metaObject()->className(), (unsigned long)&obj);
-		obj.setObjectName(name.toLower());
-	}
+		obj.setObjectName(qobject_default_name(obj));
 
 	return obj.objectName();
 }
@@ -56,6 +56,9 @@
 #include <QtLua/State>
 #include <QtLua/Function>
 #include <QtLua/Pixmap>
+#include <QtLua/NumericArray>
+#include <QtLua/ModelProxy>
+#include <QtLua/BufferProxy>
 #include <QtLua/QHashProxy>
 
 #include <internal/Method>
@@ -106,7 +109,7 @@ void qtlib_register_meta(const QMetaObject *mo, qobject_creator *creator)
 QTLUA_FUNCTION(connect)
 {
 	Q_UNUSED(ls)
-	meta_call_check_args(args, 3, 4, Value::TUserData, Value::TString, Value::TNone, Value::TString);
+	meta_call_check_args(args, 3, 4, Value::TUserData, Value::TString, Value::TNone, Value::TNone);
 
 	QObjectWrapper::ptr sigqow = args[0].to_userdata_cast<QObjectWrapper>();
 
@@ -117,18 +120,48 @@ QTLUA_FUNCTION(connect)
 	if (sigindex < 0)
 		QTLUA_THROW(qt.connect, "No such signal '%'.", .arg(signame));
 
-	switch (args.size())
+	switch (args.size() == 4 && args[3].type() == Value::TTable ? 3 : args.size())
 	{
 	case 3:
 	{
+		Value::ConnectMode mode = Value::ConnectDirect;
+		int interval = 0;
+
+		if (args.size() == 4)
+		{
+			// coalescing options table
+			Value opt_mode = args[3].at("mode");
+
+			if (!opt_mode.is_nil())
+			{
+				String m = opt_mode.to_string();
+
+				if (m == "latest")
+					mode = Value::ConnectLatest;
+				else if (m == "batch")
+					mode = Value::ConnectBatch;
+				else if (m == "queued")
+					mode = Value::ConnectQueued;
+				else if (m != "direct")
+					QTLUA_THROW(qt.connect, "Bad connection mode '%'.", .arg(m));
+			}
+
+			Value opt_interval = args[3].at("interval");
+
+			if (!opt_interval.is_nil())
+				interval = opt_interval.to_integer();
+		}
+
 		// connect qt signal to lua function
-		sigqow->_lua_connect(sigindex, args[2]);
+		sigqow->_lua_connect(sigindex, args[2], mode, interval);
 		break;
 	}
 
 	case 4:
 	{
 		// connect qt signal to qt slot
+		meta_call_check_args(args, 4, 4, Value::TUserData, Value::TString, Value::TUserData, Value::TString);
+
 		String slotname = args[3].to_string();
 		QObject &sloobj = args[2].to_userdata_cast<QObjectWrapper>()->get_object();
 
@@ -824,6 +857,75 @@ QTLUA_FUNCTION(pixmap_data)
 	return Value(ls);
 }
 
+////////////////////////////////////////////////// numeric arrays
+
+template <class A>
+static Value new_array(State *ls, const Value::List &args)
+{
+	UserData::meta_call_check_args(args, 1, 1, Value::TNone);
+	const Value &init = args[0];
+
+	if (init.type() == Value::TTable)
+	{
+		QVector<double> values = init.to_qvector<double>();
+		typename A::ptr array = QTLUA_REFNEW(A, values.size());
+		for (int i = 0; i < values.size(); i++)
+			array->elements()[i] = A::from_number(values[i]);
+		return Value(ls, array);
+	}
+
+	int size = init.to_integer();
+	if (size < 0)
+		QTLUA_THROW(qt.array, "Bad array size %.", .arg(size));
+	return Value(ls, QTLUA_REFNEW(A, size));
+}
+
+QTLUA_FUNCTION(array_float32)
+{
+	return new_array<Float32Array>(ls, args);
+}
+
+QTLUA_FUNCTION(array_float64)
+{
+	return new_array<Float64Array>(ls, args);
+}
+
+QTLUA_FUNCTION(array_int32)
+{
+	return new_array<Int32Array>(ls, args);
+}
+
+QTLUA_FUNCTION(array_uint8)
+{
+	return new_array<UInt8Array>(ls, args);
+}
+
+////////////////////////////////////////////////// item models
+
+QTLUA_FUNCTION(model_proxy)
+{
+	meta_call_check_args(args, 1, 2, Value::TUserData, Value::TNumber);
+	QAbstractItemModel *model = get_arg_qobject<QAbstractItemModel>(args, 0);
+
+	return Value(ls, QTLUA_REFNEW(ModelProxy, *model, get_arg<int>(args, 1, Qt::DisplayRole)));
+}
+
+////////////////////////////////////////////////// binary buffers
+
+QTLUA_FUNCTION(buffer_file)
+{
+	meta_call_check_args(args, 1, 1, Value::TString);
+	BufferProxy::ptr buffer = QTLUA_REFNEW(BufferProxy);
+	if (buffer->map_file(get_arg<QString>(args, 0)))
+		return Value(ls, buffer);
+	return Value(ls);
+}
+
+QTLUA_FUNCTION(buffer_data)
+{
+	meta_call_check_args(args, 1, 1, Value::TString);
+	return Value(ls, QTLUA_REFNEW(BufferProxy, get_arg<String>(args, 0)));
+}
 
 //////////////////////////////////////////////////
 
@@ -871,6 +973,16 @@ void qtluaopen_qt(State *ls)
 
 	QTLUA_FUNCTION_REGISTER2(ls, "qt.pixmap.from_file", pixmap_file);
 	QTLUA_FUNCTION_REGISTER2(ls, "qt.pixmap.from_data", pixmap_data);
+
+	QTLUA_FUNCTION_REGISTER2(ls, "qt.array.float32", array_float32);
+	QTLUA_FUNCTION_REGISTER2(ls, "qt.array.float64", array_float64);
+	QTLUA_FUNCTION_REGISTER2(ls, "qt.array.int32", array_int32);
+	QTLUA_FUNCTION_REGISTER2(ls, "qt.array.uint8", array_uint8);
+
+	QTLUA_FUNCTION_REGISTER2(ls, "qt.model.proxy", model_proxy);
+
+	QTLUA_FUNCTION_REGISTER2(ls, "qt.buffer.from_file", buffer_file);
+	QTLUA_FUNCTION_REGISTER2(ls, "qt.buffer.from_data", buffer_data);
 }
 
 }
@@ -0,0 +1,436 @@
+/*
+    This file is part of LibQtLua.
+
+    LibQtLua is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibQtLua is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LibQtLua.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright (C) 2008, Alexandre Becoulet <alexandre.becoulet@free.fr>
+
+*/
+
+#include <QtLua/Scheduler>
+#include <QtLua/State>
+#include <QtLua/Function>
+#include <QtLua/Pending>
+
+extern "C" {
+#include <lua.h>
+}
+
+namespace QtLua {
+
+/** @internal lua functions bound to a scheduler */
+class SchedulerFunction : public Function
+{
+public:
+	QTLUA_REFTYPE(SchedulerFunction)
+
+	enum Op {
+		Spawn,
+		Sleep,
+		Wait,
+		Yield,
+		Kill,
+		Stats,
+		Wake,
+	};
+
+	SchedulerFunction(Scheduler *sched, Op op, int id = 0)
+		: _sched(sched)
+		, _op(op)
+		, _id(id)
+	{
+	}
+
+private:
+	Value::List meta_call(State *ls, const Value::List &args);
+
+	QPointer<Scheduler> _sched;
+	Op _op;
+	int _id;
+};
+
+Value::List SchedulerFunction::meta_call(State *ls, const Value::List &args)
+{
+	if (!_sched)
+		QTLUA_THROW(QtLua::Scheduler, "The scheduler object has been destroyed.");
+
+	switch (_op)
+	{
+	case Spawn:
+		return Value(ls, _sched->spawn(get_arg<const Value &>(args, 0), args.mid(1)));
+
+	case Sleep:
+		_sched->sleep(_sched->current(ls), get_arg<int>(args, 0));
+		yield(ls);
+		return Value::List();
+
+	case Wait:
+		_sched->wait(_sched->current(ls), get_arg_qobject<QObject>(args, 0), get_arg<String>(args, 1));
+		yield(ls);
+		return Value::List();
+
+	case Yield:
+		_sched->current(ls);
+		yield(ls);
+		return Value::List();
+
+	case Kill:
+		return Value(ls, _sched->kill(get_arg<int>(args, 0)) ? Value::True : Value::False);
+
+	case Stats:
+	{
+		Scheduler::Stats s = _sched->get_stats();
+		Value res = Value::new_table(ls);
+
+		res["tasks"] = s.tasks;
+		res["ready"] = s.ready;
+		res["sleeping"] = s.sleeping;
+		res["waiting"] = s.waiting;
+		res["spawned"] = (double)s.spawned;
+		res["finished"] = (double)s.finished;
+		res["errors"] = (double)s.errors;
+		res["resumes"] = (double)s.resumes;
+
+		return res;
+	}
+
+	case Wake:
+		// first argument is the signal sender
+		_sched->wake(_id, args.mid(1));
+		return Value::List();
+	}
+
+	::abort();
+}
+
+Scheduler::Scheduler(State *ls, const String &path)
+	: QObject(ls)
+	, _ls(ls)
+	, _current(0)
+	, _next_id(1)
+	, _time_slice(10)
+	, _spawned(0)
+	, _finished(0)
+	, _errors(0)
+	, _resumes(0)
+{
+	_run_timer.setSingleShot(true);
+	_sleep_timer.setSingleShot(true);
+	connect(&_run_timer, SIGNAL(timeout()), this, SLOT(run()));
+	connect(&_sleep_timer, SIGNAL(timeout()), this, SLOT(wakeup_sleepers()));
+	_clock.start();
+
+	Value table = Value::new_table(ls);
+
+	table["spawn"] = QTLUA_REFNEW(SchedulerFunction, this, SchedulerFunction::Spawn);
+	table["sleep"] = QTLUA_REFNEW(SchedulerFunction, this, SchedulerFunction::Sleep);
+	table["wait"] = QTLUA_REFNEW(SchedulerFunction, this, SchedulerFunction::Wait);
+	table["yield"] = QTLUA_REFNEW(SchedulerFunction, this, SchedulerFunction::Yield);
+	table["kill"] = QTLUA_REFNEW(SchedulerFunction, this, SchedulerFunction::Kill);
+	table["stats"] = QTLUA_REFNEW(SchedulerFunction, this, SchedulerFunction::Stats);
+
+	ls->set_global(path, table);
+}
+
+Scheduler::~Scheduler()
+{
+	foreach (Task *t, _tasks)
+	{
+		if (_ls)
+			unwait(t);
+		delete t;
+	}
+}
+
+int Scheduler::spawn(const Value &function, const Value::List &args)
+{
+	if (!_ls)
+		QTLUA_THROW(QtLua::Scheduler, "State object has been destroyed.");
+
+	Value th = Value::new_thread(_ls, function);
+
+	Task *t = new Task;
+	t->_id = _next_id++;
+	t->_thread = th;
+	t->_args = args;
+	t->_error = false;
+	t->_deadline = 0;
+	t->_wait_key = 0;
+
+	lua_State *lst = _ls->get_lua_state();
+	th.push_value(lst);
+	t->_lst = lua_tothread(lst, -1);
+	lua_pop(lst, 1);
+
+	_tasks.insert(t->_id, t);
+	_spawned++;
+	make_ready(t);
+
+	return t->_id;
+}
+
+bool Scheduler::kill(int id)
+{
+	task_hash_t::iterator i = _tasks.find(id);
+
+	if (i == _tasks.end())
+		return false;
+
+	if (i.value() == _current)
+		QTLUA_THROW(QtLua::Scheduler, "Can not kill the running task.");
+
+	remove(i.value());
+	return true;
+}
+
+Scheduler::Stats Scheduler::get_stats() const
+{
+	Stats s;
+
+	s.tasks = _tasks.size();
+	s.ready = _ready.size();
+	s.sleeping = _sleepers.size();
+	s.waiting = 0;
+
+	foreach (const Task *t, _tasks)
+		if (t->_state == TaskWaiting || t->_state == TaskSuspended)
+			s.waiting++;
+
+	s.spawned = _spawned;
+	s.finished = _finished;
+	s.errors = _errors;
+	s.resumes = _resumes;
+
+	return s;
+}
+
+Scheduler::Task *Scheduler::current(State *ls) const
+{
+	if (!_current || ls->get_lua_state() != _current->_lst)
+		QTLUA_THROW(QtLua::Scheduler, "This function must be called from a scheduler task.");
+
+	return _current;
+}
+
+void Scheduler::make_ready(Task *t)
+{
+	t->_state = TaskReady;
+	_ready.enqueue(t);
+
+	if (!_run_timer.isActive())
+		_run_timer.start(0);
+}
+
+void Scheduler::run()
+{
+	QElapsedTimer slice;
+	slice.start();
+
+	// resume tasks which are ready at this point once
+	for (int count = _ready.size(); count > 0 && !_ready.isEmpty(); count--)
+	{
+		resume(_ready.dequeue());
+
+		if (slice.elapsed() >= _time_slice)
+			break;
+	}
+
+	if (!_ready.isEmpty())
+		_run_timer.start(0);
+}
+
+void Scheduler::resume(Task *t)
+{
+	if (!_ls)
+		return;
+
+	// drop the lua slot used by wait
+	unwait(t);
+
+	Value::List args = t->_args;
+	bool error = t->_error;
+	t->_args.clear();
+	t->_error = false;
+	t->_state = TaskRunning;
+	_current = t;
+	_resumes++;
+	_ls->_last_pending = 0;
+
+	try
+	{
+		_ls->resume_pending(t->_thread, args, error);
+	}
+	catch (const String &err)
+	{
+		int id = t->_id;
+
+		_current = 0;
+		_errors++;
+		remove(t);
+		emit task_error(id, err.to_qstring());
+		return;
+	}
+
+	_current = 0;
+
+	if (t->_thread.is_dead())
+	{
+		// task code may still hold its thread, so it is not recycled
+		_finished++;
+		remove(t);
+	}
+	else if (t->_state == TaskRunning)
+	{
+		Pending *p = _ls->_last_pending;
+
+		if (p && p->_thread == t->_thread)
+		{
+			// task suspended by a C++ function, the Pending object
+			// hands it back to the scheduler when resumed
+			t->_state = TaskSuspended;
+			p->_sched = this;
+			p->_task = t->_id;
+		}
+		else
+		{
+			// task has yielded, keep it in the round-robin
+			make_ready(t);
+		}
+	}
+}
+
+void Scheduler::remove(Task *t)
+{
+	switch (t->_state)
+	{
+	case TaskReady:
+		_ready.removeOne(t);
+		break;
+	case TaskSleeping:
+		_sleepers.remove(t->_deadline, t);
+		schedule_sleepers();
+		break;
+	default:
+		break;
+	}
+
+	unwait(t);
+	_tasks.remove(t->_id);
+	delete t;
+}
+
+void Scheduler::sleep(Task *t, int ms)
+{
+	t->_state = TaskSleeping;
+	t->_deadline = _clock.elapsed() + qMax(ms, 0);
+	_sleepers.insert(t->_deadline, t);
+	schedule_sleepers();
+}
+
+void Scheduler::schedule_sleepers()
+{
+	if (_sleepers.isEmpty())
+	{
+		_sleep_timer.stop();
+		return;
+	}
+
+	qint64 delay = _sleepers.begin().key() - _clock.elapsed();
+	_sleep_timer.start((int)qMax(delay, (qint64)0));
+}
+
+void Scheduler::wakeup_sleepers()
+{
+	qint64 now = _clock.elapsed();
+	sleep_map_t::iterator i;
+
+	while ((i = _sleepers.begin()) != _sleepers.end() && i.key() <= now)
+	{
+		Task *t = i.value();
+		_sleepers.erase(i);
+		make_ready(t);
+	}
+
+	schedule_sleepers();
+}
+
+void Scheduler::wait(Task *t, QObject *obj, const String &signal)
+{
+	Value waker(_ls, QTLUA_REFNEW(SchedulerFunction, this, SchedulerFunction::Wake, t->_id));
+
+	if (!waker.connect(obj, signal.constData()))
+		QTLUA_THROW(QtLua::Scheduler, "Unable to connect the `%' signal.", .arg(signal));
+
+	connect(obj, SIGNAL(destroyed(QObject*)), this, SLOT(wait_obj_destroyed(QObject*)), Qt::UniqueConnection);
+
+	t->_state = TaskWaiting;
+	t->_waker = waker;
+	t->_wait_obj = obj;
+	t->_wait_key = obj;
+	t->_wait_signal = signal;
+}
+
+void Scheduler::wake(int id, const Value::List &args)
+{
+	task_hash_t::iterator i = _tasks.find(id);
+
+	if (i == _tasks.end() || i.value()->_state != TaskWaiting)
+		return;
+
+	// the lua slot is disconnected when the task is resumed
+	i.value()->_args = args;
+	make_ready(i.value());
+}
+
+void Scheduler::resume_task(int id, const Value::List &args, bool error)
+{
+	task_hash_t::iterator i = _tasks.find(id);
+
+	if (i == _tasks.end() || i.value()->_state != TaskSuspended)
+		return;
+
+	i.value()->_args = args;
+	i.value()->_error = error;
+	make_ready(i.value());
+}
+
+void Scheduler::wait_obj_destroyed(QObject *obj)
+{
+	// guarded pointers are not cleared yet when a widget is destroyed,
+	// tasks are matched on the object address
+	foreach (Task *t, _tasks)
+	{
+		if (t->_state != TaskWaiting || t->_wait_key != obj)
+			continue;
+
+		t->_args = Value::List(Value(_ls, String("The object waited for has been destroyed.")));
+		t->_error = true;
+		make_ready(t);
+	}
+}
+
+void Scheduler::unwait(Task *t)
+{
+	if (t->_wait_signal.isEmpty())
+		return;
+
+	if (t->_wait_obj)
+		t->_waker.disconnect(t->_wait_obj, t->_wait_signal.constData());
+
+	t->_waker = Value(_ls);
+	t->_wait_key = 0;
+	t->_wait_signal.clear();
+}
+
+}
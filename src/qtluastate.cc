@@ -28,7 +28,10 @@
 #include <QtLua/Iterator>
 #include <QtLua/String>
 #include <QtLua/Function>
+#include <QtLua/Pending>
 #include <internal/QObjectWrapper>
+#include <internal/Method>
+#include <internal/MetaCache>
 
 #include "internal/qtluaqtlib.hh"
 
@@ -41,9 +44,11 @@ extern "C" {
 namespace QtLua {
 
 #define QTLUA_MAX_COMPLETION 200
+#define QTLUA_ITERATOR_BATCH 64
 
 char State::_key_item_metatable;
 char State::_key_this;
+char State::_key_threads;
 
 /* save current thread lua_State and set new lua_State */
 #define QTLUA_SWITCH_THREAD(this_, st) \
@@ -60,35 +65,65 @@ char State::_key_this;
 
 int State::lua_cmd_iterator(lua_State *st)
 {
-	State *this_ = get_this(st);
-	QTLUA_SWITCH_THREAD(this_, st);
+	// entries buffer table, buffer position and entries count are
+	// stored as upvalues so that most calls do not enter C++ code
+	int pos = lua_tointeger(st, lua_upvalueindex(2));
+	int count = lua_tointeger(st, lua_upvalueindex(3));
 
-	try
+	if (pos >= count)
 	{
-		Iterator::ptr i = Value(1, this_).to_userdata_cast<Iterator>();
+		State *this_ = get_this(st);
+		QTLUA_SWITCH_THREAD(this_, st);
 
-		if (i->more())
+		try
+		{
+			Iterator::ptr i = Value(1, this_).to_userdata_cast<Iterator>();
+
+			for (count = 0; count < QTLUA_ITERATOR_BATCH && i->more(); count++)
+			{
+				i->get_key().push_value(st);
+				lua_rawseti(st, lua_upvalueindex(1), count * 2 + 1);
+				i->get_value().push_value(st);
+				lua_rawseti(st, lua_upvalueindex(1), count * 2 + 2);
+				i->next();
+			}
+		}
+		catch (String &e)
 		{
-			i->get_key().push_value(st);
-			i->get_value().push_value(st);
-			i->next();
 			QTLUA_RESTORE_THREAD(this_);
-			return 2;
+			luaL_error(st, "%s", e.constData());
 		}
-		else
+
+		QTLUA_RESTORE_THREAD(this_);
+
+		if (!count)
 		{
 			lua_pushnil(st);
-			QTLUA_RESTORE_THREAD(this_);
 			return 1;
 		}
+
+		pos = 0;
+		lua_pushinteger(st, count);
+		lua_replace(st, lua_upvalueindex(3));
 	}
-	catch (String &e)
-	{
-		QTLUA_RESTORE_THREAD(this_);
-		luaL_error(st, "%s", e.constData());
-	}
 
-	::abort();
+	lua_pushinteger(st, pos + 1);
+	lua_replace(st, lua_upvalueindex(2));
+
+	lua_rawgeti(st, lua_upvalueindex(1), pos * 2 + 1);
+	lua_rawgeti(st, lua_upvalueindex(1), pos * 2 + 2);
+
+	// do not keep returned entries referenced from the buffer
+	lua_pushnil(st);
+	lua_rawseti(st, lua_upvalueindex(1), pos * 2 + 1);
+	lua_pushnil(st);
+	lua_rawseti(st, lua_upvalueindex(1), pos * 2 + 2);
+	return 2;
+}
+
+static int lua_next_wrapper(lua_State *st)
+{
+	return lua_next(st, 1) ? 2 : 0;
 }
 
 int State::lua_cmd_each(lua_State *st)
@@ -103,13 +138,34 @@ int State::lua_cmd_each(lua_State *st)
 		Value table;
 
 		if (lua_gettop(st) < 1)
+		{
 			table = Value::new_global_env(this_);
+		}
 		else
+		{
+			if (lua_type(st, idx) == LUA_TTABLE)
+			{
+				// plain lua table, iterate with raw lua_next
+				if (!lua_getmetatable(st, idx))
+				{
+					QTLUA_RESTORE_THREAD(this_);
+					lua_pushcfunction(st, lua_next_wrapper);
+					lua_pushvalue(st, idx);
+					lua_pushnil(st);
+					return 3;
+				}
+				lua_pop(st, 1);
+			}
+
 			table = Value(idx, this_);
+		}
 
 		Iterator::ptr i = table.new_iterator();
 
-		lua_pushcfunction(st, lua_cmd_iterator);
+		lua_createtable(st, QTLUA_ITERATOR_BATCH * 2, 0);
+		lua_pushinteger(st, 0);
+		lua_pushinteger(st, 0);
+		lua_pushcclosure(st, lua_cmd_iterator, 3);
 		i->push_ud(st);
 		lua_pushnil(st);
 	}
@@ -203,6 +259,30 @@ int State::lua_cmd_qtype(lua_State *st)
 	return 1;
 }
 
+int State::lua_cmd_new_thread(lua_State *st)
+{
+	State *this_ = get_this(st);
+
+	if (lua_type(st, 1) != LUA_TFUNCTION)
+		luaL_error(st, "Usage: new_thread(function)");
+
+	lua_State *th = this_->new_thread(st);
+	lua_pushvalue(st, 1);
+	lua_xmove(st, th, 1);
+
+	return 1;
+}
+
+int State::lua_cmd_recycle_thread(lua_State *st)
+{
+	State *this_ = get_this(st);
+
+	lua_settop(st, 1);
+	lua_pushboolean(st, this_->recycle_thread(st));
+
+	return 1;
+}
+
 // lua item metatable methods
 
 #define LUA_META_2OP_FUNC(n, op)                                                 \
@@ -328,6 +408,57 @@ int State::lua_meta_item_newindex(lua_State *st)
 	return lua_gettop(st) - x;
 }
 
+// address used to mark the error value passed to a suspended coroutine
+static char async_error_key;
+
+#if LUA_VERSION_NUM >= 502
+/* continuation of a C++ function call which has requested a yield,
+   raise error reported with Pending::fail */
+static int lua_meta_item_call_resume(lua_State *st, int base)
+{
+	if (lua_gettop(st) > base && lua_touserdata(st, base + 1) == &async_error_key)
+	{
+		lua_settop(st, base + 2);
+		return lua_error(st);
+	}
+
+	return lua_gettop(st) - base;
+}
+
+#if LUA_VERSION_NUM >= 503
+static int lua_meta_item_call_k(lua_State *st, int status, lua_KContext ctx)
+{
+	Q_UNUSED(status);
+	return lua_meta_item_call_resume(st, ctx);
+}
+#else
+static int lua_meta_item_call_k(lua_State *st)
+{
+	int ctx = 0;
+	lua_getctx(st, &ctx);
+	return lua_meta_item_call_resume(st, ctx);
+}
+#endif
+#else
+/* lua 5.1 has no continuation support, the __call event is handled
+   by a lua function which checks values returned on resume and
+   raises error reported with Pending::fail */
+static int lua_meta_item_call_check(lua_State *st)
+{
+	if (lua_gettop(st) > 0 && lua_touserdata(st, 1) == &async_error_key)
+	{
+		lua_settop(st, 2);
+		return lua_error(st);
+	}
+
+	return lua_gettop(st);
+}
+
+static const char lua_meta_item_call_wrapper[] =
+	"local call, check = ...\n"
+	"return function(...) return check(call(...)) end\n";
+#endif
+
 int State::lua_meta_item_call(lua_State *st)
 {
 	int n = lua_gettop(st);
@@ -342,23 +473,38 @@ int State::lua_meta_item_call(lua_State *st)
 		if (!ud.valid())
 			QTLUA_THROW(QtLua::UserData, "Can not call a null `QtLua::UserData' value.");
 
-		Value::List args;
+		Method::ptr method = ud.dynamiccast<Method>();
+
+		if (method.valid())
+		{
+			// Qt methods convert arguments directly from the lua stack
+			UserData::ptr obj;
+
+			if (n >= 2 && lua_type(st, 2) == LUA_TUSERDATA)
+				obj = UserData::get_ud(st, 2);
+
+			method->meta_call(this_, st, obj, 3);
+		}
+		else
+		{
+			Value::List args;
 
-		for (int i = 2; i <= lua_gettop(st); i++)
-			args.append(Value(i, this_));
+			for (int i = 2; i <= lua_gettop(st); i++)
+				args.append(Value(i, this_));
 
-		bool oy = this_->_yield_on_return;
-		this_->_yield_on_return = false;
-		args = ud->meta_call(this_, args);
-		yield = this_->_yield_on_return;
-		this_->_yield_on_return = oy;
+			bool oy = this_->_yield_on_return;
+			this_->_yield_on_return = false;
+			args = ud->meta_call(this_, args);
+			yield = this_->_yield_on_return;
+			this_->_yield_on_return = oy;
 
-		if (!lua_checkstack(st, args.size()))
-			QTLUA_THROW(QtLua::State, "Unable to extend the lua stack to handle % return values",
-						.arg(args.size()));
+			if (!lua_checkstack(st, args.size()))
+				QTLUA_THROW(QtLua::State, "Unable to extend the lua stack to handle % return values",
+							.arg(args.size()));
 
-		foreach (const Value &v, args)
-			v.push_value(st);
+			foreach (const Value &v, args)
+				v.push_value(st);
+		}
 	}
 	catch (String &e)
 	{
@@ -368,7 +514,15 @@ int State::lua_meta_item_call(lua_State *st)
 
 	QTLUA_RESTORE_THREAD(this_);
 	int nresults = lua_gettop(st) - n;
-	return yield ? lua_yield(st, nresults) : nresults;
+
+	if (!yield)
+		return nresults;
+
+#if LUA_VERSION_NUM >= 502
+	return lua_yieldk(st, nresults, n, lua_meta_item_call_k);
+#else
+	return lua_yield(st, nresults);
+#endif
 }
 
 int State::lua_meta_item_gc(lua_State *st)
@@ -454,16 +608,34 @@ void State::lua_psettable(lua_State *st, int index)
 	lua_pop(st, 2); // remove key/value
 }
 
-static int lua_next_wrapper(lua_State *st)
-{
-	return lua_next(st, 1) ? 2 : 0;
-}
-
 /** Protected lua_next, same behavior as lua_next. On error this
     function throw an exception and leave the lua stack untouched (the
     key is not poped). */
 int State::lua_pnext(lua_State *st, int index)
 {
+	if (lua_type(st, index) == LUA_TTABLE)
+	{
+		// lua_next can not fail if the key is nil or still present in table
+		if (lua_isnil(st, -1))
+			return lua_next(st, index);
+
+		int tindex = index;
+		if (tindex < 0
+#if LUA_VERSION_NUM < 502
+			&& tindex != LUA_GLOBALSINDEX
+#endif
+			)
+			tindex--;
+
+		lua_pushvalue(st, -1);
+		lua_rawget(st, tindex);
+		bool present = !lua_isnil(st, -1);
+		lua_pop(st, 1);
+
+		if (present)
+			return lua_next(st, index);
+	}
+
 	lua_pushcfunction(st, lua_next_wrapper);
 	if (index < 0
 #if LUA_VERSION_NUM < 502
@@ -490,6 +662,102 @@ int State::lua_pnext(lua_State *st, int index)
 
 /************************************************************************/
 
+void State::resume_pending(const Value &thread, const Value::List &args, bool error)
+{
+	if (!error)
+	{
+		thread.call(args);
+		return;
+	}
+
+	lua_pushlightuserdata(_lst, &async_error_key);
+	Value mark(-1, this);
+	lua_pop(_lst, 1);
+
+	thread.call(Value::List(mark) + args);
+}
+
+/************************************************************************/
+
+lua_State *State::new_thread(lua_State *st)
+{
+	if (!_thread_pool_count)
+		return lua_newthread(st);
+
+	// pool table contains thread values indexed from 1 and
+	// thread to index entries
+	lua_pushlightuserdata(st, &_key_threads);
+	lua_rawget(st, LUA_REGISTRYINDEX);
+	lua_rawgeti(st, -1, _thread_pool_count);
+	lua_pushvalue(st, -1);
+	lua_pushnil(st);
+	lua_rawset(st, -4);
+	lua_pushnil(st);
+	lua_rawseti(st, -3, _thread_pool_count--);
+	lua_remove(st, -2);
+
+	return lua_tothread(st, -1);
+}
+
+bool State::recycle_thread(lua_State *st)
+{
+	lua_State *th = lua_tothread(st, -1);
+
+	// only threads which have returned without error can be resumed again
+	if (!th || th == _mst || th == st || _thread_pool_count >= _thread_pool_size
+		|| lua_status(th) != 0 || lua_gettop(th) != 0)
+	{
+		lua_pop(st, 1);
+		return false;
+	}
+
+	lua_pushlightuserdata(st, &_key_threads);
+	lua_rawget(st, LUA_REGISTRYINDEX);
+
+	// already pooled
+	lua_pushvalue(st, -2);
+	lua_rawget(st, -2);
+	if (!lua_isnil(st, -1))
+	{
+		lua_pop(st, 3);
+		return false;
+	}
+	lua_pop(st, 1);
+
+	_thread_pool_count++;
+	lua_pushvalue(st, -2);
+	lua_pushinteger(st, _thread_pool_count);
+	lua_rawset(st, -3);
+	lua_pushvalue(st, -2);
+	lua_rawseti(st, -2, _thread_pool_count);
+	lua_pop(st, 2);
+
+	return true;
+}
+
+bool State::recycle_thread(const Value &thread)
+{
+	if (thread._st != this)
+		return false;
+
+	thread.push_value(_lst);
+	return recycle_thread(_lst);
+}
+
+void State::set_thread_pool_size(int size)
+{
+	_thread_pool_size = qMax(size, 0);
+
+	// drop extra pooled threads
+	while (_thread_pool_count > _thread_pool_size)
+	{
+		new_thread(_lst);
+		lua_pop(_lst, 1);
+	}
+}
+
+/************************************************************************/
+
 void State::set_global_r(const String &name, const Value &value, int tblidx)
 {
 	int len = name.indexOf('.', 0);
@@ -747,6 +1015,7 @@ State::State()
 	Q_ASSERT(Value::TThread == LUA_TTHREAD);
 
 	_mst = _lst = luaL_newstate();
+	_wrappers = 0;
 
 	// creat metatable for UserData events
 
@@ -772,7 +1041,17 @@ State::State()
 	LUA_META_BIND(le);
 	LUA_META_BIND(index);
 	LUA_META_BIND(newindex);
+#if LUA_VERSION_NUM >= 502
 	LUA_META_BIND(call);
+#else
+	lua_pushstring(_mst, "__call");
+	luaL_loadbuffer(_mst, lua_meta_item_call_wrapper,
+					sizeof(lua_meta_item_call_wrapper) - 1, "=qtlua");
+	lua_pushcfunction(_mst, lua_meta_item_call);
+	lua_pushcfunction(_mst, lua_meta_item_call_check);
+	lua_call(_mst, 2, 1);
+	lua_rawset(_mst, -3);
+#endif
 	LUA_META_BIND(gc);
 
 	lua_rawset(_mst, LUA_REGISTRYINDEX);
@@ -783,23 +1062,33 @@ State::State()
 	lua_pushlightuserdata(_mst, this);
 	lua_rawset(_mst, LUA_REGISTRYINDEX);
 
+	// table of reusable threads
+
+	lua_pushlightuserdata(_mst, &_key_threads);
+	lua_newtable(_mst);
+	lua_rawset(_mst, LUA_REGISTRYINDEX);
+
 	_yield_on_return = false;
+	_thread_pool_size = 32;
+	_thread_pool_count = 0;
 }
 
 State::~State()
 {
 	// disconnect all Qt slots while associated Value objects are still valid
-	foreach (QObjectWrapper *w, _whash)
+	for (QObjectWrapper *w = _wrappers; w; w = w->_ls_next)
 		w->_lua_disconnect_all();
 
+	// drop suspended coroutines which have not been resumed yet
+	foreach (Pending *p, findChildren<Pending *>())
+		delete p;
+
 	// lua state close
 	lua_close(_mst);
 
 	// wipe QObjectWrapper objects
-	wrapper_hash_t::const_iterator i;
-
-	while ((i = _whash.begin()) != _whash.end())
-		i.value()->_drop();
+	while (_wrappers)
+		_wrappers->_drop();
 
 	foreach (Function *function, _functions)
 		delete function;
@@ -959,6 +1248,11 @@ State *State::get_this(lua_State *st)
 	lua_pop(st, 1);
 #endif
 
+void State::prebuild_meta_cache()
+{
+	MetaCache::prebuild();
+}
+
 bool State::openlib(Library lib)
 {
 	switch (lib)
@@ -1036,6 +1330,8 @@ bool State::openlib(Library lib)
 		reg_c_function("list", lua_cmd_list);
 		reg_c_function("each", lua_cmd_each);
 		reg_c_function("qtype", lua_cmd_qtype);
+		reg_c_function("new_thread", lua_cmd_new_thread);
+		reg_c_function("recycle_thread", lua_cmd_recycle_thread);
 		return true;
 
 	case QtLib:
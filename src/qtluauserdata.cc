@@ -30,6 +30,7 @@ extern "C" {
 #include <QtLua/Value>
 #include <QtLua/State>
 #include <QtLua/String>
+#include <QtLua/Pending>
 
 namespace QtLua {
 
@@ -246,4 +247,17 @@ Value UserData::yield(State *ls) const
 	return res;
 }
 
+Pending *UserData::suspend(State *ls) const
+{
+	Value th = yield(ls);
+
+	if (th.type() != Value::TThread)
+	{
+		ls->_yield_on_return = false;
+		QTLUA_THROW(QtLua::UserData, "Can not suspend execution outside of a lua coroutine.");
+	}
+
+	return new Pending(ls, th);
+}
+
 }
@@ -57,12 +57,12 @@ void Value::init_global()
 	lua_rawset(lst, LUA_REGISTRYINDEX);
 }
 
-void Value::init_table()
+void Value::init_table(int array_size, int hash_size)
 {
 	check_state();
 	lua_State *lst = _st->_lst;
 	lua_pushnumber(lst, _id);
-	lua_newtable(lst);
+	lua_createtable(lst, array_size, hash_size);
 	lua_rawset(lst, LUA_REGISTRYINDEX);
 }
 
@@ -71,7 +71,7 @@ void Value::init_thread(const Value &main)
 	check_state();
 	lua_State *lst = _st->_lst;
 	lua_pushnumber(lst, _id);
-	lua_State *th = lua_newthread(lst);
+	lua_State *th = _st->new_thread(lst);
 
 	try
 	{
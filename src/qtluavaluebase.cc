@@ -50,6 +50,11 @@ void ValueBase::check_state() const
 }
 
 bool ValueBase::connect(QObject *obj, const char *signal)
+{
+	return connect(obj, signal, ConnectDirect, 0);
+}
+
+bool ValueBase::connect(QObject *obj, const char *signal, ConnectMode mode, int interval)
 {
 	check_state();
 	try
@@ -62,7 +67,7 @@ bool ValueBase::connect(QObject *obj, const char *signal)
 		if (sigid < 0 || mo->method(sigid).methodType() != QMetaMethod::Signal)
 			return false;
 
-		qow->_lua_connect(sigid, *this);
+		qow->_lua_connect(sigid, *this, mode, interval);
 	}
 	catch (const String &e)
 	{
@@ -380,6 +385,208 @@ void ValueBase::table_shift(int pos, int count, const Value &init, int len)
 	lua_pop(lst, 1);
 }
 
+ValueBase::List ValueBase::table_raw_get(int first, int count) const
+{
+	check_state();
+	lua_State *lst = _st->_lst;
+	push_value(lst);
+
+	if (lua_type(lst, -1) != LUA_TTABLE)
+	{
+		lua_pop(lst, 1);
+		QTLUA_THROW(QtLua::ValueBase, "Can only get a range of values from a `lua::table' value.");
+	}
+
+	List res;
+	res.reserve(count);
+
+	for (int i = 0; i < count; i++)
+	{
+		lua_rawgeti(lst, -1, first + i);
+		res.push_back(Value(-1, _st));
+		lua_pop(lst, 1);
+	}
+
+	lua_pop(lst, 1);
+	return res;
+}
+
+void ValueBase::table_raw_set(int first, const List &values) const
+{
+	check_state();
+	lua_State *lst = _st->_lst;
+	push_value(lst);
+
+	if (lua_type(lst, -1) != LUA_TTABLE)
+	{
+		lua_pop(lst, 1);
+		QTLUA_THROW(QtLua::ValueBase, "Can only set a range of values in a `lua::table' value.");
+	}
+
+	for (int i = 0; i < values.size(); i++)
+	{
+		try
+		{
+			values[i].push_value(lst);
+		}
+		catch (...)
+		{
+			lua_pop(lst, 1);
+			throw;
+		}
+		lua_rawseti(lst, -2, first + i);
+	}
+
+	lua_pop(lst, 1);
+}
+
+lua_State *ValueBase::raw_table_push() const
+{
+	check_state();
+	lua_State *lst = _st->_lst;
+	push_value(lst);
+
+	if (lua_type(lst, -1) != LUA_TTABLE)
+	{
+		lua_pop(lst, 1);
+		QTLUA_THROW(QtLua::ValueBase, "Can only access a range of values in a `lua::table' value.");
+	}
+
+	return lst;
+}
+
+void ValueBase::raw_table_pop(lua_State *st)
+{
+	lua_pop(st, 1);
+}
+
+void ValueBase::raw_table_new(lua_State *st, int array_size)
+{
+	lua_createtable(st, array_size, 0);
+}
+
+void ValueBase::raw_table_seti(lua_State *st, int index)
+{
+	lua_rawseti(st, -2, index);
+}
+
+void ValueBase::raw_seti(lua_State *st, int index, const QVariant &v) const
+{
+	QMetaValue::raw_push_object(_st, st, v.userType(), v.constData());
+	lua_rawseti(st, -2, index);
+}
+
+void ValueBase::raw_seti(lua_State *st, int index, double n)
+{
+	lua_pushnumber(st, n);
+	lua_rawseti(st, -2, index);
+}
+
+void ValueBase::raw_seti(lua_State *st, int index, float n)
+{
+	lua_pushnumber(st, n);
+	lua_rawseti(st, -2, index);
+}
+
+void ValueBase::raw_seti(lua_State *st, int index, int n)
+{
+	lua_pushnumber(st, n);
+	lua_rawseti(st, -2, index);
+}
+
+void ValueBase::raw_seti(lua_State *st, int index, unsigned int n)
+{
+	lua_pushnumber(st, n);
+	lua_rawseti(st, -2, index);
+}
+
+void ValueBase::raw_seti(lua_State *st, int index, const String &str)
+{
+	lua_pushlstring(st, str.constData(), str.size());
+	lua_rawseti(st, -2, index);
+}
+
+void ValueBase::raw_seti(lua_State *st, int index, const QString &str)
+{
+	raw_seti(st, index, String(str));
+}
+
+void ValueBase::raw_seti(lua_State *st, int index, const Value &v)
+{
+	v.push_value(st);
+	lua_rawseti(st, -2, index);
+}
+
+Value ValueBase::raw_geti(lua_State *st, int index) const
+{
+	lua_rawgeti(st, -1, index);
+	Value res(-1, _st);
+	lua_pop(st, 1);
+	return res;
+}
+
+void ValueBase::raw_geti(lua_State *st, int index, double &n) const
+{
+	lua_rawgeti(st, -1, index);
+
+	if (lua_type(st, -1) == LUA_TNUMBER)
+	{
+		n = lua_tonumber(st, -1);
+		lua_pop(st, 1);
+		return;
+	}
+
+	// slow path for conversions and errors
+	lua_pop(st, 1);
+	n = raw_geti(st, index).to_number();
+}
+
+void ValueBase::raw_geti(lua_State *st, int index, float &n) const
+{
+	double d;
+	raw_geti(st, index, d);
+	n = d;
+}
+
+void ValueBase::raw_geti(lua_State *st, int index, int &n) const
+{
+	double d;
+	raw_geti(st, index, d);
+	n = (int)d;
+}
+
+void ValueBase::raw_geti(lua_State *st, int index, unsigned int &n) const
+{
+	double d;
+	raw_geti(st, index, d);
+	n = (unsigned int)d;
+}
+
+void ValueBase::raw_geti(lua_State *st, int index, String &str) const
+{
+	lua_rawgeti(st, -1, index);
+
+	if (lua_type(st, -1) == LUA_TSTRING)
+	{
+		size_t len;
+		const char *s = lua_tolstring(st, -1, &len);
+		str = String(s, len);
+		lua_pop(st, 1);
+		return;
+	}
+
+	// slow path for conversions and errors
+	lua_pop(st, 1);
+	str = raw_geti(st, index).to_string();
+}
+
+void ValueBase::raw_geti(lua_State *st, int index, QString &str) const
+{
+	String s;
+	raw_geti(st, index, s);
+	str = s.to_qstring();
+}
+
 Ref<Iterator> ValueBase::new_iterator() const
 {
 	check_state();
@@ -4,6 +4,7 @@ TEMPLATE = lib
 TARGET = qtlua
 
 SOURCES +=                                 \
+    qtluabufferproxy.cc                    \
     qtluadispatchproxy.cc                  \
     qtluaenum.cc                           \
     qtluaenumiterator.cc                   \
@@ -11,7 +12,10 @@ SOURCES +=                                 \
     qtluamember.cc                         \
     qtluametacache.cc                      \
     qtluamethod.cc                         \
+    qtluamodelproxy.cc                     \
+    qtluapending.cc                        \
     qtluapixmap.cc                         \
+    qtluaproxynotifier.cc                  \
     qtluaproperty.cc                       \
     qtluaqmetaobjecttable.cc               \
     qtluaqmetaobjectwrapper.cc             \
@@ -19,6 +23,7 @@ SOURCES +=                                 \
     qtluaqobjectiterator.cc                \
     qtluaqobjectwrapper.cc                 \
     qtluaqtlib.cc                          \
+    qtluascheduler.cc                      \
     qtluastate.cc                          \
     qtluatableiterator.cc                  \
     qtluauserdata.cc                       \
@@ -49,6 +54,8 @@ HEADERS +=                                 \
                                            \
     QtLua/qtluaarrayproxy.hh               \
     QtLua/qtluaarrayproxy.hxx              \
+    QtLua/qtluabufferproxy.hh              \
+    QtLua/qtluabufferproxy.hxx             \
     QtLua/qtluadispatchproxy.hh            \
     QtLua/qtluadispatchproxy.hxx           \
     QtLua/qtluafunction.hh                 \
@@ -57,7 +64,13 @@ HEADERS +=                                 \
     QtLua/qtluaiterator.hxx                \
     QtLua/qtluametatype.hh                 \
     QtLua/qtluametatype.hxx                \
+    QtLua/qtluamodelproxy.hh               \
+    QtLua/qtluanumericarray.hh             \
+    QtLua/qtluanumericarray.hxx            \
+    QtLua/qtluapending.hh                  \
+    QtLua/qtluapending.hxx                 \
     QtLua/qtluapixmap.hh                   \
+    QtLua/qtluaproxynotifier.hh            \
     QtLua/qtluaqhashproxy.hh               \
     QtLua/qtluaqhashproxy.hxx              \
     QtLua/qtluaqlinkedlistproxy.hh         \
@@ -67,6 +80,8 @@ HEADERS +=                                 \
     QtLua/qtluaqvectorproxy.hh             \
     QtLua/qtluaqvectorproxy.hxx            \
     QtLua/qtluaref.hh                      \
+    QtLua/qtluascheduler.hh                \
+    QtLua/qtluascheduler.hxx               \
     QtLua/qtluastate.hh                    \
     QtLua/qtluastate.hxx                   \
     QtLua/qtluastring.hh                   \
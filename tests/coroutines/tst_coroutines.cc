@@ -23,6 +23,8 @@
 #include <QtLua/State>
 #include <QtLua/Value>
 #include <QtLua/Function>
+#include <QtLua/Pending>
+#include <QtLua/Scheduler>
 
 #define QVERIFY_NORET(statement) \
 	QTest::qVerify((statement), #statement, "", __FILE__, __LINE__)
@@ -39,6 +41,24 @@ QTLUA_FUNCTION(test)
 	return QtLua::Value(ls, a * 2);
 }
 
+QTLUA_FUNCTION(async)
+{
+	QtLua::Pending *p = suspend(ls);
+
+	p->resume(QtLua::Value(ls, args[0].to_integer() * 2));
+
+	return QtLua::Value::List();
+}
+
+QTLUA_FUNCTION(async_fail)
+{
+	QtLua::Pending *p = suspend(ls);
+
+	p->fail("async failure");
+
+	return QtLua::Value::List();
+}
+
 class Corutines : public QObject
 {
 	Q_OBJECT
@@ -48,6 +68,10 @@ private slots:
 	void test2();
 	void test3();
 	void test4();
+	void test5();
+	void test6();
+	void test7();
+	void test8();
 };
 
 void Corutines::test1()
@@ -162,6 +186,149 @@ void Corutines::test4()
 	ls.check_empty_stack();
 }
 
-QTEST_APPLESS_MAIN(Corutines)
+void Corutines::test5()
+{
+	QtLua_Function_async async;
+	QtLua::State ls;
+	ls.openlib(QtLua::AllLibs);
+
+	ls["async"] = async;
+	QtLua::Value m = ls.exec_statements("return function(a) result = async(a) + 1 end").at(0);
+	QtLua::Value co = QtLua::Value::new_thread(&ls, m);
+
+	co(QtLua::Value(&ls, 20));
+	ls.check_empty_stack();
+	QVERIFY(ls["result"].is_nil());
+
+	QCoreApplication::processEvents();
+	ls.check_empty_stack();
+	QCOMPARE(ls["result"].to_integer(), 41);
+
+	bool err = false;
+	try
+	{
+		ls["async"](QtLua::Value(&ls, 1));
+	}
+	catch (...)
+	{
+		err = true;
+	}
+	ls.check_empty_stack();
+	QVERIFY(err);
+
+	// failure is raised as an error in the coroutine on all lua versions
+	QtLua_Function_async_fail async_fail;
+	ls["async_fail"] = async_fail;
+	ls["result"] = QtLua::Value(&ls, 0);
+	m = ls.exec_statements("return function(a) local r = async_fail(a) result = 1 end").at(0);
+	co = QtLua::Value::new_thread(&ls, m);
+
+	co(QtLua::Value(&ls, 3));
+	ls.check_empty_stack();
+	QVERIFY(!co.is_dead());
+
+	QCoreApplication::processEvents();
+	ls.check_empty_stack();
+	QCOMPARE(ls["result"].to_integer(), 0);
+	QVERIFY(co.is_dead());
+}
+
+void Corutines::test6()
+{
+	QtLua::State ls;
+	ls.openlib(QtLua::AllLibs);
+
+	QtLua::Scheduler sched(&ls);
+
+	ls.exec_statements("log = ''"
+					   "sched.spawn(function(n) for i = 1, 3 do log = log..n..i sched.yield() end end, 'a')"
+					   "sched.spawn(function(n) for i = 1, 3 do log = log..n..i coroutine.yield() end end, 'b')"
+					   "sched.spawn(function() sched.sleep(20) log = log..'s' end)");
+	ls.check_empty_stack();
+	QCOMPARE(sched.get_stats().tasks, 3);
+
+	for (int i = 0; i < 100 && sched.get_stats().tasks; i++)
+		QTest::qWait(5);
+
+	ls.check_empty_stack();
+	QVERIFY(ls["log"].to_string() == "a1b1a2b2a3b3s");
+	QCOMPARE(sched.get_stats().tasks, 0);
+	QCOMPARE(sched.get_stats().finished, (qint64)3);
+	QCOMPARE(sched.get_stats().errors, (qint64)0);
+}
+
+void Corutines::test7()
+{
+	QtLua::State ls;
+	ls.openlib(QtLua::AllLibs);
+
+	QtLua::Value m = ls.exec_statements("return function(a) return a + 1 end").at(0);
+	QtLua::Value co = QtLua::Value::new_thread(&ls, m);
+
+	QVERIFY(!ls.recycle_thread(co));
+	QCOMPARE(co(QtLua::Value(&ls, 1)).at(0).to_integer(), 2);
+	ls.check_empty_stack();
+
+	QCOMPARE(ls.get_thread_pool_count(), 0);
+	QVERIFY(ls.recycle_thread(co));
+	QVERIFY(!ls.recycle_thread(co));
+	QCOMPARE(ls.get_thread_pool_count(), 1);
+	ls.check_empty_stack();
+
+	QtLua::Value co2 = QtLua::Value::new_thread(&ls, m);
+	QCOMPARE(ls.get_thread_pool_count(), 0);
+	QVERIFY(co2 == co);
+	QCOMPARE(co2(QtLua::Value(&ls, 5)).at(0).to_integer(), 6);
+	ls.check_empty_stack();
+
+	ls.exec_statements("co = new_thread(function() return 1 end) coroutine.resume(co) r = recycle_thread(co)");
+	QVERIFY(ls["r"].to_boolean());
+	QCOMPARE(ls.get_thread_pool_count(), 1);
+
+	ls.set_thread_pool_size(0);
+	QCOMPARE(ls.get_thread_pool_count(), 0);
+	ls.check_empty_stack();
+}
+
+void Corutines::test8()
+{
+	QtLua_Function_async async;
+	QtLua::State ls;
+	ls.openlib(QtLua::AllLibs);
+
+	QtLua::Scheduler sched(&ls);
+	ls["async"] = async;
+
+	/* task suspended by a Pending call is resumed once, with results */
+	ls.exec_statements("r = 0 sched.spawn(function() r = async(20) + 1 end)");
+
+	for (int i = 0; i < 100 && sched.get_stats().tasks; i++)
+		QTest::qWait(5);
+
+	ls.check_empty_stack();
+	QCOMPARE(ls["r"].to_integer(), 41);
+	QCOMPARE(sched.get_stats().tasks, 0);
+	QCOMPARE(sched.get_stats().errors, (qint64)0);
+	QCOMPARE(sched.get_stats().resumes, (qint64)2);
+
+	/* task waiting on a destroyed object does not hang */
+	QTimer *timer = new QTimer;
+	ls["timer"] = timer;
+	ls.exec_statements("sched.spawn(function() sched.wait(timer, 'timeout()') end)");
+
+	for (int i = 0; i < 100 && !sched.get_stats().waiting; i++)
+		QTest::qWait(5);
+	QCOMPARE(sched.get_stats().waiting, 1);
+
+	delete timer;
+
+	for (int i = 0; i < 100 && sched.get_stats().tasks; i++)
+		QTest::qWait(5);
+
+	ls.check_empty_stack();
+	QCOMPARE(sched.get_stats().tasks, 0);
+}
+
+QTEST_MAIN(Corutines)
 
 #include "tst_coroutines.moc"
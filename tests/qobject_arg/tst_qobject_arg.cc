@@ -19,10 +19,14 @@
 */
 
 #include <QtTest>
+#include <QAbstractTableModel>
 
 #include <QtLua/State>
 #include <QtLua/Value>
 #include <QtLua/UserData>
+#include <QtLua/ModelProxy>
+#include <QtLua/QVectorProxy>
+#include <QtLua/QHashProxy>
 
 struct MyObjectUD : public QObject
 {
@@ -94,6 +98,11 @@ public:
 		emit qo_arg(qo);
 	}
 
+	Q_INVOKABLE int sum(int a, int b = 10, int c = 100)
+	{
+		return a + b + c;
+	}
+
 	QObject *_qo;
 
 public slots:
@@ -106,6 +115,127 @@ signals:
 	void qo_arg(QObject *o);
 };
 
+struct MyObjectProp : public QObject
+{
+	Q_OBJECT
+	Q_ENUMS(Mode)
+	Q_PROPERTY(int count READ count WRITE set_count)
+	Q_PROPERTY(QString label READ label WRITE set_label)
+	Q_PROPERTY(QSize size READ size WRITE set_size)
+	Q_PROPERTY(Mode mode READ mode WRITE set_mode)
+
+public:
+	enum Mode
+	{
+		ModeA,
+		ModeB
+	};
+
+	MyObjectProp()
+		: QObject(0)
+		, _count(0)
+		, _mode(ModeA)
+	{
+	}
+
+	int count() const { return _count; }
+	void set_count(int c)
+	{
+		_count = c;
+		emit count_changed(c);
+	}
+	QString label() const { return _label; }
+	void set_label(const QString &l) { _label = l; }
+	QSize size() const { return _size; }
+	void set_size(const QSize &s) { _size = s; }
+	Mode mode() const { return _mode; }
+	void set_mode(Mode m) { _mode = m; }
+
+	int _count;
+	QString _label;
+	QSize _size;
+	Mode _mode;
+
+signals:
+	void count_changed(int c);
+	void defsig(int a = 1);
+};
+
+struct MyEmitter : public QThread
+{
+	MyObjectProp *_obj;
+
+	void run()
+	{
+		for (int i = 1; i <= 50; i++)
+			_obj->set_count(i);
+	}
+};
+
+struct MyTableModel : public QAbstractTableModel
+{
+	int rowCount(const QModelIndex &parent = QModelIndex()) const
+	{
+		return parent.isValid() ? 0 : _rows.size();
+	}
+
+	int columnCount(const QModelIndex &parent = QModelIndex()) const
+	{
+		return parent.isValid() ? 0 : 2;
+	}
+
+	QVariant data(const QModelIndex &index, int role) const
+	{
+		if (!index.isValid() || (role != Qt::DisplayRole && role != Qt::EditRole))
+			return QVariant();
+		return _rows[index.row()][index.column()];
+	}
+
+	QVariant headerData(int section, Qt::Orientation orientation, int role) const
+	{
+		if (orientation != Qt::Horizontal || role != Qt::DisplayRole)
+			return QVariant();
+		return section ? "value" : "name";
+	}
+
+	bool setData(const QModelIndex &index, const QVariant &value, int role)
+	{
+		if (!index.isValid() || (role != Qt::DisplayRole && role != Qt::EditRole))
+			return false;
+		_rows[index.row()][index.column()] = value.toString();
+		emit dataChanged(index, index);
+		return true;
+	}
+
+	bool insertRows(int row, int count, const QModelIndex &parent = QModelIndex())
+	{
+		beginInsertRows(parent, row, row + count - 1);
+		for (int i = 0; i < count; i++)
+			_rows.insert(row, QStringList() << QString() << QString());
+		endInsertRows();
+		return true;
+	}
+
+	bool removeRows(int row, int count, const QModelIndex &parent = QModelIndex())
+	{
+		beginRemoveRows(parent, row, row + count - 1);
+		for (int i = 0; i < count; i++)
+			_rows.removeAt(row);
+		endRemoveRows();
+		return true;
+	}
+
+	QList<QStringList> _rows;
+};
+
+struct MyPrebuilder : public QThread
+{
+	void run()
+	{
+		QtLua::State::prebuild_meta_cache();
+	}
+};
+
 /**/
 
 class QObjectArgs : public QObject
@@ -116,6 +246,18 @@ private slots:
 	void test1();
 	void test2();
 	void test3();
+	void test4();
+	void test5();
+	void test6();
+	void test7();
+	void test8();
+	void test9();
+	void test10();
+	void test11();
+	void test12();
+	void test13();
+	void test14();
+	void test15();
 };
 
 void QObjectArgs::test1()
@@ -203,6 +345,500 @@ void QObjectArgs::test3()
 	QCOMPARE(r[0].to_number(), 84.0);
 }
 
-QTEST_APPLESS_MAIN(QObjectArgs)
+void QObjectArgs::test4()
+{
+	QtLua::State ls;
+
+	MyObjectQO *myobj = new MyObjectQO();
+	myobj->setObjectName("parent");
+
+	// unnamed child is scanned before any named sibling
+	QObject *unnamed = new QObject(myobj);
+
+	QObject *child = new QObject(myobj);
+	child->setObjectName("child");
+
+	// child with the name of a member
+	QObject *shadow = new QObject(myobj);
+	shadow->setObjectName("objectName");
+
+	ls["o"] = myobj;
+
+	QCOMPARE(ls.exec_statements("return o.child").at(0).to_qobject(), child);
+	ls.check_empty_stack();
+	QVERIFY(ls.exec_statements("return o.missing").at(0).is_nil());
+	ls.check_empty_stack();
+
+	// lookups have gone through the unnamed child without naming it
+	QVERIFY(unnamed->objectName().isEmpty());
+
+	// members take precedence over children
+	QCOMPARE(ls.exec_statements("return o.objectName").at(0).to_string().constData(), "parent");
+	ls.check_empty_stack();
+	QCOMPARE(shadow->parent(), (QObject *)myobj);
+}
+
+void QObjectArgs::test5()
+{
+	QtLua::State ls;
+
+	MyObjectProp *myobj = new MyObjectProp();
+	ls["o"] = myobj;
+
+	ls.exec_statements("o.count = 12; o.label = 'abc'; o.size = { 3, 4 }; o.mode = 1");
+	ls.check_empty_stack();
+
+	QCOMPARE(myobj->_count, 12);
+	QCOMPARE(myobj->_label, QString("abc"));
+	QCOMPARE(myobj->_size, QSize(3, 4));
+	QCOMPARE(myobj->_mode, MyObjectProp::ModeB);
+
+	QtLua::Value::List r = ls.exec_statements("return o.count + 1, o.label, o.size[2], o.mode");
+	ls.check_empty_stack();
+
+	QCOMPARE(r[0].to_number(), 13.0);
+	QCOMPARE(r[1].to_string().constData(), "abc");
+	QCOMPARE(r[2].to_number(), 4.0);
+	QCOMPARE(r[3].to_number(), 1.0);
+}
+
+void QObjectArgs::test6()
+{
+	QtLua::State ls;
+
+	ls.openlib(QtLua::QtLib);
+
+	MyObjectProp *myobj = new MyObjectProp();
+	ls["o"] = myobj;
+
+	ls.exec_statements("n = 0; last = 0; batch = 0;"
+					   "qt.connect(o, 'count_changed(int)', function(o, c) n = n + 1; last = c; end, { mode = 'latest' });"
+					   "qt.connect(o, 'count_changed(int)', function(o, b) batch = #b; end, { mode = 'batch' });");
+	ls.check_empty_stack();
+
+	for (int i = 1; i <= 100; i++)
+		myobj->set_count(i);
+
+	// delivered from event loop only
+	QCOMPARE(ls.at("n").to_number(), 0.0);
+
+	QCoreApplication::processEvents();
+
+	QCOMPARE(ls.at("n").to_number(), 1.0);
+	QCOMPARE(ls.at("last").to_number(), 100.0);
+	QCOMPARE(ls.at("batch").to_number(), 100.0);
+	ls.check_empty_stack();
+}
+
+void QObjectArgs::test7()
+{
+	QtLua::State ls;
+
+	ls.openlib(QtLua::QtLib);
+
+	MyObjectProp *myobj = new MyObjectProp();
+	ls["o"] = myobj;
+
+	ls.exec_statements("n = 0; last = 0;"
+					   "qt.connect(o, 'count_changed(int)', function(o, c) n = n + 1; last = c; end);");
+	ls.check_empty_stack();
+
+	MyEmitter emitter;
+	emitter._obj = myobj;
+	emitter.start();
+	emitter.wait();
+
+	// emissions from worker thread are queued
+	QCOMPARE(ls.at("n").to_number(), 0.0);
+
+	QCoreApplication::processEvents();
+
+	QCOMPARE(ls.at("n").to_number(), 50.0);
+	QCOMPARE(ls.at("last").to_number(), 50.0);
+	ls.check_empty_stack();
+}
+
+void QObjectArgs::test8()
+{
+	QtLua::State ls;
+
+	ls.openlib(QtLua::QtLib);
+	ls.register_qobject_meta_noconstruct<MyObjectProp>();
+
+	QtLua::Value::List r = ls.exec_statements("local m = qt.meta.MyObjectProp;"
+											  "return m.ModeB, m['ModeA|ModeB'], m['ModeB | ModeB'], m.Nothing, m['ModeA|Nothing'],"
+											  "  m['MyObjectProp::ModeB'], m['ModeA|MyObjectProp::ModeB']");
+	ls.check_empty_stack();
+
+	QCOMPARE(r[0].to_number(), 1.0);
+	QCOMPARE(r[1].to_number(), 1.0);
+	QCOMPARE(r[2].to_number(), 1.0);
+	QCOMPARE(r[3].type(), QtLua::Value::TNil);
+	QCOMPARE(r[4].type(), QtLua::Value::TNil);
+	QCOMPARE(r[5].to_number(), 1.0);
+	QCOMPARE(r[6].to_number(), 1.0);
+}
+
+void QObjectArgs::test9()
+{
+	MyTableModel model;
+	model._rows << (QStringList() << "a" << "1")
+				<< (QStringList() << "b" << "2")
+				<< (QStringList() << "c" << "3");
+	QtLua::ModelProxy proxy(model);
+
+	QtLua::State ls;
+	ls["m"] = proxy;
+
+	QtLua::Value::List r = ls.exec_statements("local rows = m:rows(2) "
+											  "return #m, m[2][1], m[4], #rows, rows[2][1], m[3].value, #rows[1],"
+											  "  #m:rows(2, nil, 'display')");
+	ls.check_empty_stack();
+
+	QCOMPARE(r[0].to_integer(), 3);
+	QCOMPARE(r[1].to_string().constData(), "b");
+	QCOMPARE(r[2].type(), QtLua::Value::TNil);
+	QCOMPARE(r[3].to_integer(), 2);
+	QCOMPARE(r[4].to_string().constData(), "c");
+	QCOMPARE(r[5].to_string().constData(), "3");
+	QCOMPARE(r[6].to_integer(), 2);
+	QCOMPARE(r[7].to_integer(), 2);
+
+	ls.exec_statements("m[1][1] = 'z'");
+	QCOMPARE(model._rows[0][0], QString("z"));
+
+	/* cached row must be dropped on model changes */
+	model.setData(model.index(1, 0), "y", Qt::EditRole);
+	model.insertRows(0, 1);
+	r = ls.exec_statements("return #m, m[3][1]");
+	QCOMPARE(r[0].to_integer(), 4);
+	QCOMPARE(r[1].to_string().constData(), "y");
+
+	/* row objects follow their model row */
+	ls.exec_statements("r = m[3]");
+	model.insertRows(0, 1);
+	r = ls.exec_statements("return r.name");
+	QCOMPARE(r[0].to_string().constData(), "y");
+
+	model.removeRows(3, 1);
+	r = ls.exec_statements("return r.name");
+	QCOMPARE(r[0].type(), QtLua::Value::TNil);
+
+	bool err = false;
+	try
+	{
+		ls.exec_statements("r.name = 'x'");
+	}
+	catch (...)
+	{
+		err = true;
+	}
+	ls.check_empty_stack();
+	QVERIFY(err);
+}
+
+void QObjectArgs::test10()
+{
+	QVector<double> vector(3);
+	QtLua::QVectorProxy<QVector<double>, 16> proxy(vector);
+
+	QHash<QtLua::String, double> hash;
+	QtLua::QHashProxy<QHash<QtLua::String, double> > hproxy(hash);
+
+	QtLua::State ls;
+	ls.openlib(QtLua::BaseLib);
+	ls["v"] = proxy;
+	ls["h"] = hproxy;
+
+	ls.exec_statements("calls = 0 "
+					   "v:observe(function(c) calls = calls + 1 changes = c end) "
+					   "v[1] = 5 v[2] = 6 v[5] = 1 v[4] = nil");
+	ls.check_empty_stack();
+
+	/* changes are delivered from the event loop */
+	QCOMPARE(ls["calls"].to_integer(), 0);
+	QCoreApplication::processEvents();
+
+	QtLua::Value::List r = ls.exec_statements(
+		"local a, b, c = changes[1], changes[2], changes[3] "
+		"return calls, #changes, a.type, a.first, a.last, "
+		"b.type, b.first, b.last, c.type, c.first, c.last");
+
+	QCOMPARE(r[0].to_integer(), 1);
+	QCOMPARE(r[1].to_integer(), 3);
+	QCOMPARE(r[2].to_string().constData(), "set");
+	QCOMPARE(r[3].to_integer(), 1);
+	QCOMPARE(r[4].to_integer(), 2);
+	QCOMPARE(r[5].to_string().constData(), "insert");
+	QCOMPARE(r[6].to_integer(), 4);
+	QCOMPARE(r[7].to_integer(), 5);
+	QCOMPARE(r[8].to_string().constData(), "remove");
+	QCOMPARE(r[9].to_integer(), 4);
+	QCOMPARE(r[10].to_integer(), 5);
+
+	/* C++ side change report */
+	vector[1] = 42;
+	proxy.notifier().notify_changed(2, 2);
+	QCoreApplication::processEvents();
+
+	r = ls.exec_statements("return calls, #changes, changes[1].first");
+	QCOMPARE(r[0].to_integer(), 2);
+	QCOMPARE(r[1].to_integer(), 1);
+	QCOMPARE(r[2].to_integer(), 2);
+
+	/* all changes of a key are combined in a single record, an insert
+	   followed by a remove of the same key is dropped */
+	ls.exec_statements("h:observe(function(c) hchanges = c end) "
+					   "for i = 1, 1000 do h.a = i end "
+					   "h.b = 1 h.c = 1 h.b = nil h.c = 2");
+	ls.check_empty_stack();
+	QCoreApplication::processEvents();
+
+	r = ls.exec_statements("local a, c = hchanges[1], hchanges[2] "
+						   "return #hchanges, a.key, a.type, c.key, c.type");
+	QCOMPARE(r[0].to_integer(), 2);
+	QCOMPARE(r[1].to_string().constData(), "a");
+	QCOMPARE(r[2].to_string().constData(), "insert");
+	QCOMPARE(r[3].to_string().constData(), "c");
+	QCOMPARE(r[4].to_string().constData(), "insert");
+
+	/* proxy may be collected from one of its observers */
+	typedef QtLua::QVectorProxy<QVector<double>, 16> VectorProxy;
+	QVector<double> vector2(2);
+	ls["w"] = QTLUA_REFNEW(VectorProxy, vector2);
+	ls.exec_statements("wcalls = 0 "
+					   "w:observe(function(c) wcalls = wcalls + 1 w = nil collectgarbage() end) "
+					   "w:observe(function(c) wcalls = wcalls + 1 end) "
+					   "w[1] = 1");
+	ls.check_empty_stack();
+	QCoreApplication::processEvents();
+
+	QCOMPARE(ls["wcalls"].to_integer(), 1);
+	QCOMPARE(ls["w"].type(), QtLua::Value::TNil);
+}
+
+void QObjectArgs::test11()
+{
+	QtLua::State ls;
+
+	MyObjectQO *myobj = new MyObjectQO();
+	ls["o"] = myobj;
+
+	/* method variants generated for default arguments */
+	QtLua::Value::List r = ls.exec_statements("return o:sum(1), o:sum(1, 2), o:sum(1, 2, 3)");
+	ls.check_empty_stack();
+
+	QCOMPARE(r[0].to_integer(), 111);
+	QCOMPARE(r[1].to_integer(), 103);
+	QCOMPARE(r[2].to_integer(), 6);
+
+	bool err = false;
+	try
+	{
+		ls.exec_statements("return o:sum(1, 2, 3, 4)");
+	}
+	catch (...)
+	{
+		err = true;
+	}
+	ls.check_empty_stack();
+	QVERIFY(err);
+
+	err = false;
+	try
+	{
+		ls.exec_statements("return o:sum()");
+	}
+	catch (...)
+	{
+		err = true;
+	}
+	ls.check_empty_stack();
+	QVERIFY(err);
+}
+
+void QObjectArgs::test12()
+{
+	QObject parent;
+	MyObjectProp *myobj = new MyObjectProp();
+	myobj->setParent(&parent);
+
+	QtLua::State ls1;
+	ls1["a"] = myobj;
+
+	QtLua::State *ls2 = new QtLua::State();
+	ls2->openlib(QtLua::QtLib);
+	(*ls2)["a"] = myobj;
+	ls2->exec_statements("n = 0; qt.connect(a, 'count_changed(int)', function(o, c) n = c end)");
+	ls2->check_empty_stack();
+
+	QtLua::State ls3;
+	ls3["a"] = myobj;
+
+	// each State finds its own wrapper through the QObject user data
+	ls1["b"] = myobj;
+	(*ls2)["b"] = myobj;
+	ls3["b"] = myobj;
+	QVERIFY(ls1.at("a").to_userdata() == ls1.at("b").to_userdata());
+	QVERIFY(ls2->at("a").to_userdata() == ls2->at("b").to_userdata());
+	QVERIFY(ls3.at("a").to_userdata() == ls3.at("b").to_userdata());
+	QVERIFY(!(ls1.at("a").to_userdata() == ls2->at("a").to_userdata()));
+
+	myobj->set_count(3);
+	QCOMPARE(ls2->at("n").to_number(), 3.0);
+
+	// State teardown unlinks its wrapper from the middle of the chain
+	// and disconnects its lua slots
+	delete ls2;
+	myobj->set_count(4);
+
+	ls1["c"] = myobj;
+	ls3["c"] = myobj;
+	QVERIFY(ls1.at("a").to_userdata() == ls1.at("c").to_userdata());
+	QVERIFY(ls3.at("a").to_userdata() == ls3.at("c").to_userdata());
+
+	// wrap again from a new State
+	{
+		QtLua::State ls4;
+		ls4["a"] = myobj;
+		ls4["b"] = myobj;
+		QVERIFY(ls4.at("a").to_userdata() == ls4.at("b").to_userdata());
+		QCOMPARE(ls4.exec_statements("return a.count")[0].to_number(), 4.0);
+		ls4.check_empty_stack();
+	}
+
+	QCOMPARE(ls1.exec_statements("return a.count")[0].to_number(), 4.0);
+	QCOMPARE(ls3.exec_statements("return c.count")[0].to_number(), 4.0);
+	ls1.check_empty_stack();
+	ls3.check_empty_stack();
+
+	// wrappers of all remaining States are detached on object deletion
+	delete myobj;
+
+	bool err = false;
+	try
+	{
+		ls1.exec_statements("return a.count");
+	}
+	catch (...)
+	{
+		err = true;
+	}
+	ls1.check_empty_stack();
+	QVERIFY(err);
+}
+
+void QObjectArgs::test13()
+{
+	QtLua::State ls;
+
+	ls.openlib(QtLua::QtLib);
+
+	MyObjectProp *myobj = new MyObjectProp();
+	ls["o"] = myobj;
+
+	// first queued handler call reuses its slot id for other connections
+	ls.exec_statements("n1 = 0; n2 = 0; n3 = 0;"
+					   "function h2(o) n2 = n2 + 1 end;"
+					   "function h3(o, c) n3 = n3 + 1 end;"
+					   "function h1(o, c) n1 = n1 + 1;"
+					   "  qt.disconnect(o, 'count_changed(int)', h1);"
+					   "  qt.connect(o, 'destroyed(QObject*)', h2);"
+					   "  qt.connect(o, 'count_changed(int)', h3, { mode = 'queued' });"
+					   "end;"
+					   "qt.connect(o, 'count_changed(int)', h1, { mode = 'queued' });");
+	ls.check_empty_stack();
+
+	for (int i = 1; i <= 10; i++)
+		myobj->set_count(i);
+
+	QCoreApplication::processEvents();
+
+	// remaining emissions of the drained batch are dropped
+	QCOMPARE(ls.at("n1").to_number(), 1.0);
+	QCOMPARE(ls.at("n2").to_number(), 0.0);
+	QCOMPARE(ls.at("n3").to_number(), 0.0);
+
+	myobj->set_count(11);
+	QCoreApplication::processEvents();
+
+	QCOMPARE(ls.at("n1").to_number(), 1.0);
+	QCOMPARE(ls.at("n3").to_number(), 1.0);
+	ls.check_empty_stack();
+}
+
+void QObjectArgs::test14()
+{
+	// build shared member wrappers from several threads at once
+	MyPrebuilder threads[4];
+
+	for (int i = 0; i < 4; i++)
+		threads[i].start();
+
+	QtLua::State::prebuild_meta_cache();
+
+	for (int i = 0; i < 4; i++)
+		threads[i].wait();
+
+	QObject obj;
+	obj.setObjectName("prebuilt");
+
+	QtLua::State ls;
+	ls.openlib(QtLua::QtLib);
+	ls["o"] = &obj;
+
+	QtLua::Value::List r = ls.exec_statements("o.objectName = o.objectName .. '_ok';"
+											  "return o.objectName, qt.meta.QObject ~= nil");
+	ls.check_empty_stack();
+
+	QCOMPARE(r[0].to_string().constData(), "prebuilt_ok");
+	QVERIFY(r[1].to_boolean());
+	QCOMPARE(obj.objectName(), QString("prebuilt_ok"));
+}
+
+void QObjectArgs::test15()
+{
+	QtLua::State ls;
+
+	ls.openlib(QtLua::QtLib);
+
+	MyObjectProp *myobj = new MyObjectProp();
+	ls["o"] = myobj;
+
+	// cloned signal of a signal with default argument
+	ls.exec_statements("n0 = 0; n1 = 0; last = 0;"
+					   "qt.connect(o, 'defsig()', function(o) n0 = n0 + 1; end);"
+					   "qt.connect(o, 'defsig(int)', function(o, a) n1 = n1 + 1; last = a; end);");
+	ls.check_empty_stack();
+
+	emit myobj->defsig();
+	emit myobj->defsig(5);
+
+	QCOMPARE(ls.at("n0").to_number(), 2.0);
+	QCOMPARE(ls.at("n1").to_number(), 2.0);
+	QCOMPARE(ls.at("last").to_number(), 5.0);
+	ls.check_empty_stack();
+
+	// emissions from an other thread still coalesce
+	ls.exec_statements("n = 0; last = 0;"
+					   "qt.connect(o, 'count_changed(int)', function(o, c) n = n + 1; last = c; end, { mode = 'latest' });");
+	ls.check_empty_stack();
+
+	MyEmitter emitter;
+	emitter._obj = myobj;
+	emitter.start();
+	emitter.wait();
+
+	QCOMPARE(ls.at("n").to_number(), 0.0);
+
+	QCoreApplication::processEvents();
+	QCoreApplication::processEvents();
+
+	QCOMPARE(ls.at("n").to_number(), 1.0);
+	QCOMPARE(ls.at("last").to_number(), 50.0);
+	ls.check_empty_stack();
+}
+
+QTEST_MAIN(QObjectArgs)
 
 #include "tst_qobject_arg.moc"
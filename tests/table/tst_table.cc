@@ -22,6 +22,11 @@
 
 #include <QtLua/State>
 #include <QtLua/Value>
+#include <QtLua/QVectorProxy>
+#include <QtLua/QListProxy>
+#include <QtLua/QLinkedListProxy>
+#include <QtLua/QHashProxy>
+#include <QtLua/DispatchProxy>
 
 class Table : public QObject
 {
@@ -34,6 +39,11 @@ private slots:
 	void test4();
 	void test5();
 	void test6();
+	void test7();
+	void test8();
+	void test9();
+	void test10();
+	void test11();
 };
 
 void Table::test1()
@@ -419,6 +429,290 @@ void Table::test6()
 	}
 }
 
+void Table::test7()
+{
+	QVector<double> vector;
+	vector << 1 << 2 << 3 << 4 << 5;
+	QtLua::QVectorProxy<QVector<double>, 16> vproxy(vector);
+
+	QList<QtLua::String> list;
+	list << "a" << "b";
+	QtLua::QListProxy<QList<QtLua::String> > lproxy(list);
+
+	QtLua::State ls;
+	ls["v"] = vproxy;
+	ls["l"] = lproxy;
+
+	QtLua::Value::List res = ls.exec_statements(
+		"local s = v:slice(2, -2) return #s, s[1], s[3], #v:slice()");
+	QCOMPARE(res[0].to_integer(), 3);
+	QCOMPARE(res[1].to_integer(), 2);
+	QCOMPARE(res[2].to_integer(), 4);
+	QCOMPARE(res[3].to_integer(), 5);
+	ls.check_empty_stack();
+
+	ls.exec_statements("v:assign(4, {40, 50, 60}) v:append_table({70})");
+	QCOMPARE(vector.size(), 7);
+	QCOMPARE(vector[3], 40.0);
+	QCOMPARE(vector[5], 60.0);
+	QCOMPARE(vector[6], 70.0);
+
+	ls.exec_statements("v:resize(2)");
+	QCOMPARE(vector.size(), 2);
+
+	/* elements which are not numbers are converted */
+	ls.exec_statements("v:assign(1, {'8', 9})");
+	QCOMPARE(vector[0], 8.0);
+	QCOMPARE(vector[1], 9.0);
+
+	bool err = false;
+	try
+	{
+		ls.exec_statements("v:assign(1, {{}})");
+	}
+	catch (...)
+	{
+		err = true;
+	}
+	ls.check_empty_stack();
+	QVERIFY(err);
+
+	/* failed conversion leaves the vector unchanged */
+	err = false;
+	try
+	{
+		ls.exec_statements("v:assign(2, {1, 2, {}})");
+	}
+	catch (...)
+	{
+		err = true;
+	}
+	ls.check_empty_stack();
+	QVERIFY(err);
+	QCOMPARE(vector.size(), 2);
+	QCOMPARE(vector[0], 8.0);
+	QCOMPARE(vector[1], 9.0);
+
+	err = false;
+	try
+	{
+		ls.exec_statements("v:resize(17)");
+	}
+	catch (...)
+	{
+		err = true;
+	}
+	ls.check_empty_stack();
+	QVERIFY(err);
+
+	ls.exec_statements("l:append_table({'c', 'd'}) l:assign(1, {'z'})");
+	QCOMPARE(list.size(), 4);
+	QCOMPARE(list[0].constData(), "z");
+	QCOMPARE(list[3].constData(), "d");
+
+	ls.exec_statements("l:assign(2, {42})");
+	QCOMPARE(list[1].constData(), "42");
+
+	err = false;
+	try
+	{
+		ls.exec_statements("l:append_table({'e', {}})");
+	}
+	catch (...)
+	{
+		err = true;
+	}
+	ls.check_empty_stack();
+	QVERIFY(err);
+	QCOMPARE(list.size(), 4);
+
+	res = ls.exec_statements("return l:slice(3)");
+	QCOMPARE(res[0].len(), 2);
+	QCOMPARE(res[0].at(1).to_string().constData(), "c");
+	ls.check_empty_stack();
+}
+
+void Table::test8()
+{
+	typedef QMap<QtLua::String, QtLua::String> Container;
+
+	Container c1, c2;
+	c1.insert("a", "1");
+	c2.insert("b", "2");
+
+	QtLua::QHashProxyRo<Container> p1(c1);
+	QtLua::QHashProxy<Container> p2(c2);
+
+	QtLua::DispatchProxy dp;
+	dp.add_target(&p1);
+	dp.add_target(&p2);
+	dp.set_key_cache(true);
+
+	QtLua::State ls;
+	ls["d"] = dp;
+
+	QtLua::Value::List res = ls.exec_statements("d.c = 'x' return d.a, d.b, d.b, d.c");
+	QCOMPARE(res[0].to_string().constData(), "1");
+	QCOMPARE(res[1].to_string().constData(), "2");
+	QCOMPARE(res[2].to_string().constData(), "2");
+	QCOMPARE(res[3].to_string().constData(), "x");
+	QCOMPARE(c2.value("c").constData(), "x");
+
+	/* key moved to an earlier target must be found after invalidation */
+	c1.insert("b", "3");
+	dp.invalidate_routes();
+	res = ls.exec_statements("return d.b");
+	QCOMPARE(res[0].to_string().constData(), "3");
+
+	bool err = false;
+	try
+	{
+		ls.exec_statements("d.a = 'y'");
+	}
+	catch (...)
+	{
+		err = true;
+	}
+	ls.check_empty_stack();
+	QVERIFY(err);
+}
+
+void Table::test9()
+{
+	QLinkedList<double> list;
+	for (int i = 1; i <= 100; i++)
+		list.append(i);
+
+	QtLua::QLinkedListProxy<QLinkedList<double> > proxy(list);
+
+	QtLua::State ls;
+	ls["l"] = proxy;
+
+	QtLua::Value::List res = ls.exec_statements(
+		"local s, r = 0, 0 "
+		"for i = 1, #l do s = s + l[i] end "
+		"for i = #l, 1, -1 do r = r * 2 % 1000 + l[i] end "
+		"return s, r, l[50], l[101]");
+	ls.check_empty_stack();
+
+	int r = 0;
+	for (int i = 100; i >= 1; i--)
+		r = r * 2 % 1000 + i;
+
+	QCOMPARE(res[0].to_number(), 5050.0);
+	QCOMPARE(res[1].to_integer(), r);
+	QCOMPARE(res[2].to_number(), 50.0);
+	QCOMPARE(res[3].type(), QtLua::Value::TNil);
+
+	res = ls.exec_statements("l[1] = nil l[#l + 1] = 7 return l[1], l[#l], #l:to_table()");
+	QCOMPARE(res[0].to_number(), 2.0);
+	QCOMPARE(res[1].to_number(), 7.0);
+	QCOMPARE(res[2].to_integer(), 100);
+
+	ls.exec_statements("l:from_table({3, 2, 1}) l[2] = 5");
+	QCOMPARE(list.size(), 3);
+	QCOMPARE(list.first(), 3.0);
+	QCOMPARE(*(++list.begin()), 5.0);
+}
+
+void Table::test10()
+{
+	QMap<double, QtLua::String> map;
+	for (int i = 0; i < 100; i++)
+		map.insert(i * 10, QtLua::String::number(i));
+
+	QtLua::QHashProxyRo<QMap<double, QtLua::String> > proxy(map);
+
+	QtLua::State ls;
+	ls["m"] = proxy;
+
+	QtLua::Value::List res = ls.exec_statements(
+		"local k, v = m:range(95, 130) "
+		"return #k, k[1], v[4], m:count_range(nil, 45), m:count_range(50, 10)");
+	ls.check_empty_stack();
+
+	QCOMPARE(res[0].to_integer(), 4);
+	QCOMPARE(res[1].to_number(), 100.0);
+	QCOMPARE(res[2].to_string().constData(), "13");
+	QCOMPARE(res[3].to_integer(), 5);
+	QCOMPARE(res[4].to_integer(), 0);
+
+	res = ls.exec_statements("local a, b = m:lower_bound(20) local c = m:upper_bound(20) "
+							 "local d = m:first() local e = m:last() "
+							 "return a, b, c, d, e, m:lower_bound(1000) == nil");
+	QCOMPARE(res[0].to_number(), 20.0);
+	QCOMPARE(res[1].to_string().constData(), "2");
+	QCOMPARE(res[2].to_number(), 30.0);
+	QCOMPARE(res[3].to_number(), 0.0);
+	QCOMPARE(res[4].to_number(), 990.0);
+	QVERIFY(res[5].to_boolean());
+}
+
+void Table::test11()
+{
+	QVector<double> vector;
+	for (int i = 1; i <= 200; i++)
+		vector.append(i);
+
+	QtLua::QVectorProxy<QVector<double> > proxy(vector);
+
+	QtLua::State ls;
+	ls.openlib(QtLua::BaseLib);
+	ls.openlib(QtLua::QtLuaLib);
+	ls["v"] = proxy;
+
+	/* user data iteration crosses several batches */
+	QtLua::Value::List res = ls.exec_statements(
+		"local n, s, last = 0, 0, 0 "
+		"for k, x in each(v) do "
+		"  if k ~= last + 1 then error('bad key order') end "
+		"  n, s, last = n + 1, s + x, k "
+		"end return n, s");
+	ls.check_empty_stack();
+	QCOMPARE(res[0].to_integer(), 200);
+	QCOMPARE(res[1].to_number(), 20100.0);
+
+	/* entries of the current batch have already been fetched */
+	res = ls.exec_statements(
+		"local seen = {} "
+		"for k, x in each(v) do "
+		"  if k == 1 then v[2] = -1 v[100] = -1 end "
+		"  seen[k] = x "
+		"end return seen[2], seen[100]");
+	QCOMPARE(res[0].to_number(), 2.0);
+	QCOMPARE(res[1].to_number(), -1.0);
+
+	/* raw lua_next path on plain tables, clearing fields while iterating */
+	res = ls.exec_statements(
+		"local t = {} for i = 1, 200 do t[i] = i end t.x = 1000 "
+		"local n, s = 0, 0 "
+		"for k, x in each(t) do n, s = n + 1, s + x t[k] = nil end "
+		"return n, s, next(t) == nil");
+	QCOMPARE(res[0].to_integer(), 201);
+	QCOMPARE(res[1].to_number(), 21100.0);
+	QVERIFY(res[2].to_boolean());
+
+	/* table iterator, lua_pnext falls back to pcall on removed keys */
+	res = ls.exec_statements(
+		"local m = setmetatable({}, {}) for i = 1, 200 do m[i] = i end "
+		"local n, s = 0, 0 "
+		"for k, x in each(m) do n, s = n + 1, s + x m[k] = nil end "
+		"return n, s, next(m) == nil");
+	QCOMPARE(res[0].to_integer(), 200);
+	QCOMPARE(res[1].to_number(), 20100.0);
+	QVERIFY(res[2].to_boolean());
+
+	/* lua_pnext fast path from C++ */
+	QtLua::Value t = ls.exec_statements("t2 = {} for i = 1, 200 do t2[i] = i end return t2").at(0);
+	int n = 0;
+	double sum = 0;
+	for (QtLua::Value::const_iterator i = t.begin(); i != t.end(); i++, n++)
+		sum += i.value().to_number();
+	QCOMPARE(n, 200);
+	QCOMPARE(sum, 20100.0);
+	ls.check_empty_stack();
+}
+
 QTEST_APPLESS_MAIN(Table)
 
 #include "tst_table.moc"
@@ -22,6 +22,8 @@
 
 #include <QtLua/State>
 #include <QtLua/Value>
+#include <QtLua/NumericArray>
+#include <QtLua/BufferProxy>
 
 class Value : public QObject
 {
@@ -34,6 +36,8 @@ private slots:
 	void test4();
 	void test5();
 	void test6();
+	void test7();
+	void test8();
 };
 
 void Value::test1()
@@ -129,6 +133,181 @@ void Value::test6()
 	QVERIFY(func(num).at(0).to_number() + 1.0 < 0.001);
 }
 
+void Value::test7()
+{
+	QtLua::State ls;
+
+	QVector<float> samples;
+	samples << 3 << -1 << 2 << 4 << 0.5;
+
+	QtLua::Float32Array::ptr a = QTLUA_REFNEW(QtLua::Float32Array, samples);
+	QtLua::Float32Array::ptr b = QTLUA_REFNEW(QtLua::Float32Array, 5);
+	ls["a"] = a;
+	ls["b"] = b;
+
+	QtLua::Value::List res = ls.exec_statements(
+		"b:fill(2) a:axpy(0.5, b) "
+		"return #a, a[1], a:sum(), a:dot(b), a:min(), a:max(), a[6]");
+
+	QCOMPARE(res.size(), 7);
+	QCOMPARE(res[0].to_integer(), 5);
+	QCOMPARE(res[1].to_number(), 4.0);
+	QCOMPARE(res[2].to_number(), 13.5);
+	QCOMPARE(res[3].to_number(), 27.0);
+	QCOMPARE(res[4].to_number(), 0.0);
+	QCOMPARE(res[5].to_number(), 5.0);
+	QCOMPARE(res[6].type(), QtLua::Value::TNil);
+
+	/* attached container is updated in place */
+	QCOMPARE(samples[0], 4.0f);
+
+	ls.exec_statements("a:clamp(1, 3) a:sort() a[1] = 7");
+	QCOMPARE(samples[0], 7.0f);
+	QCOMPARE(samples[4], 3.0f);
+
+	/* owned storage is shared with a QVector without copy */
+	QVector<float> shared = b->data();
+	QCOMPARE(shared.constData(), b->data().constData());
+
+	/* integer arrays saturate out of range values */
+	QtLua::Int32Array::ptr i = QTLUA_REFNEW(QtLua::Int32Array, 3);
+	QtLua::UInt8Array::ptr u = QTLUA_REFNEW(QtLua::UInt8Array, 2);
+	QtLua::Float32Array::ptr c = QTLUA_REFNEW(QtLua::Float32Array, 3);
+	ls["i"] = i;
+	ls["u"] = u;
+	ls["c"] = c;
+
+	res = ls.exec_statements(
+		"u[1] = 300 u[2] = -5 i:fill(1e12) i[2] = 0/0 i[3] = -1e12 "
+		"return u[1], u[2], i[1], i[2], i[3]");
+
+	QCOMPARE(res[0].to_integer(), 255);
+	QCOMPARE(res[1].to_integer(), 0);
+	QCOMPARE(res[2].to_integer(), 2147483647);
+	QCOMPARE(res[3].to_integer(), 0);
+	QCOMPARE(res[4].to_number(), -2147483648.0);
+
+	ls.exec_statements("i:fill(2000000000) i:scale(-10) u:fill(200) u:axpy(2, u)");
+	QCOMPARE(i->elements()[0], (qint32)-2147483647 - 1);
+	QCOMPARE(u->elements()[0], (quint8)255);
+
+	/* integer add and mul saturate instead of overflowing */
+	ls.exec_statements("i:fill(2000000000) i:add(i) u:fill(200) u:mul(u)");
+	QCOMPARE(i->elements()[0], (qint32)2147483647);
+	QCOMPARE(u->elements()[0], (quint8)255);
+
+	ls.exec_statements("i:fill(-2000000000) i:add(-2000000000) i[2] = 70000 i:mul(i)");
+	QCOMPARE(i->elements()[0], (qint32)2147483647);
+	QCOMPARE(i->elements()[1], (qint32)2147483647);
+
+	/* empty arrays have no bounds */
+	QtLua::Float32Array::ptr e = QTLUA_REFNEW(QtLua::Float32Array, 0);
+	ls["e"] = e;
+	res = ls.exec_statements("return e:min(), e:max()");
+	QCOMPARE(res[0].type(), QtLua::Value::TNil);
+	QCOMPARE(res[1].type(), QtLua::Value::TNil);
+
+	bool err = false;
+	try
+	{
+		e->min();
+	}
+	catch (...)
+	{
+		err = true;
+	}
+	QVERIFY(err);
+
+	/* bounds, size and type errors */
+	static const char *bad[] = {
+		"b:add(qt_wrong)",
+		"b:add('x')",
+		"b:add(c)",
+		"b:mul(c)",
+		"b:axpy(1, c)",
+		"return b:dot(c)",
+		"b:add(i)",
+		"b:axpy(1, u)",
+		"b[6] = 1",
+		"b[0] = 1",
+		"i[4] = 1",
+		0
+	};
+
+	for (const char **s = bad; *s; s++)
+	{
+		err = false;
+		try
+		{
+			ls.exec_statements(*s);
+		}
+		catch (...)
+		{
+			err = true;
+		}
+		QVERIFY2(err, *s);
+	}
+
+	/* failed operations leave arrays untouched */
+	QCOMPARE(b->size(), 5);
+	QCOMPARE(b->elements()[0], 2.0f);
+}
+
+void Value::test8()
+{
+	QtLua::State ls;
+
+	QByteArray data("\x01\xff\x34\x12\x00\x00\x80\x3f" "abcabc", 14);
+	QtLua::BufferProxy::ptr b = QTLUA_REFNEW(QtLua::BufferProxy, data);
+	ls["b"] = b;
+
+	/* data is shared without copy */
+	QCOMPARE(b->data(), (const uchar *)data.constData());
+
+	QtLua::Value::List res = ls.exec_statements(
+		"return #b, b[2], b:i8(2), b:u16le(3), b:u16be(3), b:f32(5), "
+		"b:sub(9, 11), b:sub(-2), b[15], b:find('ca')");
+
+	QCOMPARE(res.size(), 11);
+	QCOMPARE(res[0].to_integer(), 14);
+	QCOMPARE(res[1].to_integer(), 255);
+	QCOMPARE(res[2].to_integer(), -1);
+	QCOMPARE(res[3].to_integer(), 0x1234);
+	QCOMPARE(res[4].to_integer(), 0x3412);
+	QCOMPARE(res[5].to_number(), 1.0);
+	QCOMPARE(res[6].to_string().constData(), "abc");
+	QCOMPARE(res[7].to_string().constData(), "bc");
+	QCOMPARE(res[8].type(), QtLua::Value::TNil);
+	QCOMPARE(res[9].to_integer(), 11);
+	QCOMPARE(res[10].to_integer(), 12);
+
+	bool err = false;
+	try
+	{
+		ls.exec_statements("return b:u32le(12)");
+	}
+	catch (...)
+	{
+		err = true;
+	}
+	QVERIFY(err);
+
+	/* memory mapped file */
+	QTemporaryFile file;
+	QVERIFY(file.open());
+	file.write(data);
+	file.close();
+
+	QtLua::BufferProxy::ptr m = QTLUA_REFNEW(QtLua::BufferProxy);
+	QVERIFY(m->map_file(file.fileName()));
+	ls["m"] = m;
+
+	res = ls.exec_statements("return #m, m:sub(9), m:u16le(3)");
+	QCOMPARE(res[0].to_integer(), 14);
+	QCOMPARE(res[1].to_string().constData(), "abcabc");
+	QCOMPARE(res[2].to_integer(), 0x1234);
+}
+
 QTEST_APPLESS_MAIN(Value)
 
 #include "tst_value.moc"